@@ -0,0 +1,123 @@
+//*************************************************************************
+// File plist.cc
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// cex Library PropertyList benchmark (flat list vs. previous map based list)
+//*************************************************************************
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <cex/plist.hpp>
+
+//***************************************************************************
+// previous implementation (std::map of shared_ptr<Property>)
+//***************************************************************************
+
+namespace legacy
+{
+
+class Property
+{
+   public:
+
+      explicit Property(const std::string& value) : stringValue(value), longValue(0), doubleValue(0), ptrValue(nullptr) {}
+      explicit Property(long value)               : longValue(value), doubleValue(0), ptrValue(nullptr) {}
+
+      const std::string& getStringValue() const { return stringValue; }
+      long getLongValue() const                 { return longValue; }
+
+   private:
+      std::string stringValue;
+      long longValue;
+      double doubleValue;
+      void* ptrValue;
+};
+
+class PropertyList
+{
+   public:
+
+      long getLong(const std::string& key)
+      {
+         auto res= entries.find(key);
+         return res != entries.end() ? res->second.get()->getLongValue() : 0;
+      }
+
+      std::string getString(const std::string& key)
+      {
+         auto res= entries.find(key);
+         return res != entries.end() ? res->second.get()->getStringValue() : std::string();
+      }
+
+      void set(const std::string& key, const std::string& value)   { entries[key]= std::make_shared<Property>(value); }
+      void set(const std::string& key, long value)                 { entries[key]= std::make_shared<Property>(value); }
+
+      bool has(const std::string& key)    { return entries.count(key) > 0; }
+
+   private:
+
+      std::map<std::string, std::shared_ptr<Property>> entries;
+};
+
+} // namespace legacy
+
+//***************************************************************************
+// benchmark
+//***************************************************************************
+
+// typical request: a handful of properties set by middlewares (auth, session, ...)
+// and read several times by later middlewares
+
+template<typename List>
+static double run(size_t iterations, long& checksum)
+{
+   auto start= std::chrono::steady_clock::now();
+
+   for (size_t i= 0; i < iterations; i++)
+   {
+      List list;
+
+      list.set("basicUsername", std::string("john"));
+      list.set("basicPassword", std::string("secret"));
+      list.set("sessionId", std::string("0123456789abcdef0123456789abcdef"));
+      list.set("userId", (long)i);
+      list.set("retries", 3L);
+
+      for (int n= 0; n < 4; n++)
+      {
+         checksum += list.getLong("userId");
+         checksum += (long)list.getString("basicUsername").size();
+         checksum += list.has("sslClientCert") ? 1 : 0;
+      }
+   }
+
+   std::chrono::duration<double, std::nano> elapsed= std::chrono::steady_clock::now() - start;
+
+   return elapsed.count() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+   size_t iterations= argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+   long checksum= 0;
+
+   double legacyNs= run<legacy::PropertyList>(iterations, checksum);
+   double flatNs= run<cex::PropertyList>(iterations, checksum);
+
+   printf("PropertyList (%zu iterations, 5 sets + 12 lookups each)\n", iterations);
+   printf("   std::map + shared_ptr:  %8.1f ns/iteration\n", legacyNs);
+   printf("   flat small-buffer:      %8.1f ns/iteration (%.1fx)\n", flatNs, legacyNs / flatNs);
+   printf("   (checksum %ld)\n", checksum);
+
+   return 0;
+}
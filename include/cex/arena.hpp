@@ -0,0 +1,131 @@
+//*************************************************************************
+// File arena.hpp
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// Class Arena
+// Per-request bump allocator
+//*************************************************************************
+
+#ifndef __ARENA_HPP__
+#define __ARENA_HPP__
+
+/*! \file arena.hpp
+  \brief Bump allocator backing the per-request objects */
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace cex
+{
+
+//***************************************************************************
+// class Arena
+//***************************************************************************
+/*! \class Arena
+  \brief Bump allocator for objects which share the lifetime of a request.
+
+  Memory is carved from blocks of `blockSize` bytes. Single objects are never freed,
+  all memory is released at once with reset(). Allocations larger than a quarter
+  block are passed on to `malloc` and freed individually by deallocate() (or with reset()),
+  so growing buffers do not waste arena blocks.
+
+  Arenas are recycled: acquire() takes one from a per-thread freelist, release()
+  resets it and puts it back. An arena must only be used by one thread at a time.
+  */
+
+class Arena
+{
+   public:
+
+      static const size_t blockSize= 8192;
+
+      Arena();
+      ~Arena();
+
+      Arena(const Arena&) = delete;
+      Arena& operator=(const Arena&) = delete;
+
+      /*! \brief Allocates `size` bytes with the given alignment */
+      void* allocate(size_t size, size_t align= alignof(std::max_align_t));
+
+      /*! \brief Frees large allocations. Arena memory is only reclaimed if it was the last allocation */
+      void deallocate(void* p, size_t size);
+
+      /*! \brief Copies `len` bytes of `s` into the arena and appends a terminating zero */
+      char* strdup(const char* s, size_t len);
+
+      /*! \brief Constructs an object of type `T` in the arena. The destructor must be called explicitly */
+      template<typename T, typename... Args>
+      T* create(Args&&... args) { return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...); }
+
+      /*! \brief Releases all memory except the first block */
+      void reset();
+
+      /*! \brief Returns an (empty) arena from the calling thread's freelist */
+      static Arena* acquire();
+
+      /*! \brief Resets the arena and returns it to the calling thread's freelist */
+      static void release(Arena* arena);
+
+   private:
+
+      struct Block
+      {
+         Block* next;
+      };
+
+      Block* first;
+      Block* current;
+      char* pos;
+      char* end;
+      std::vector<void*> large;
+};
+
+//***************************************************************************
+// class ArenaAllocator
+//***************************************************************************
+/*! \class ArenaAllocator
+  \brief STL allocator drawing memory from an Arena. Without an arena, the global heap is used. */
+
+template<typename T>
+class ArenaAllocator
+{
+   public:
+
+      typedef T value_type;
+
+      template<typename U> struct rebind { typedef ArenaAllocator<U> other; };
+
+      explicit ArenaAllocator(Arena* arena= nullptr) : arena(arena) {}
+      template<typename U> ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+      T* allocate(size_t n)
+      {
+         return (T*)(arena ? arena->allocate(n * sizeof(T), alignof(T)) : ::operator new(n * sizeof(T)));
+      }
+
+      void deallocate(T* p, size_t n)
+      {
+         if (arena)
+            arena->deallocate(p, n * sizeof(T));
+         else
+            ::operator delete(p);
+      }
+
+      template<typename U> bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+      template<typename U> bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+      Arena* arena;
+};
+
+//***************************************************************************
+} // namespace cex
+
+#endif // __ARENA_HPP__
@@ -17,7 +17,26 @@
   to retrieve `Basic` authentication information.
 
   Upon success (e.g. a `Authorization` header is present and its contents could be extracted) stores the 
-  values in the Request object's properties `basicUsername` and `basicPassword`.
+  values in the Request object's BasicCredentials slot. They are also available as the properties
+  `basicUsername` and `basicPassword`.
+
+Example:
+```
+   app.use(cex::basicAuth());
+
+   app.use([](cex::Request* req, cex::Response* res, std::function<void()> next)
+   {
+      cex::BasicCredentials* credentials= req->slot<cex::BasicCredentials>();
+
+      if (!credentials || credentials->username != "john")
+      {
+         res->end(401);
+         return;
+      }
+
+      next();
+   });
+```
 */
 
 //***************************************************************************
@@ -30,6 +49,19 @@
 namespace cex
 {
 
+//***************************************************************************
+// definitions
+//***************************************************************************
+
+/*! \struct BasicCredentials
+  \brief Username and password extracted by the basicAuth middleware (request slot) */
+
+struct BasicCredentials
+{
+   std::string username;
+   std::string password;
+};
+
 //**************************************************************************
 // Middlewares
 //***************************************************************************
@@ -17,19 +17,31 @@
 
 #include <evhtp/evhtp.h>
 #include <event2/thread.h>
+#include <sys/uio.h>
 
+#include <atomic>
+#include <chrono>
 #include <thread>
 #include <condition_variable>
 #include <functional>
+#include <initializer_list>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <regex>
 
+#include "arena.hpp"
+#include "headers.hpp"
 #include "plist.hpp"
+#include "slot.hpp"
+#include "router.hpp"
 #include "cex_config.hpp"
 
 #define IO_BUFFER_SIZE (128*1024)
+#define STREAM_WATERMARK (4*IO_BUFFER_SIZE)
+#define MAX_BODY_RESERVE (32*IO_BUFFER_SIZE)
 
 namespace cex
 {
@@ -90,6 +102,7 @@ enum Protocol
 
 class Request;
 class Response;
+class AsyncHandle;
 
 /*! \brief Returns the library version as string */
 const char* getLibraryVersion();
@@ -99,7 +112,12 @@ const char* getLibraryVersion();
 //***************************************************************************
 
 typedef std::shared_ptr<Request> ReqPtr;
+typedef std::vector<StringView, ArenaAllocator<StringView>> BodySegments;
 typedef std::shared_ptr<Response> ResPtr;
+typedef std::shared_ptr<AsyncHandle> AsyncHandlePtr;
+
+/*! \brief Immutable response payload which can be shared by many responses without copying (see Response::end) */
+typedef std::string Buffer;
 
 /*! \public
    \brief A function which is called by a standard Middleware when an incoming request matches.
@@ -115,7 +133,8 @@ typedef std::function<void(Request* req, Response* res, const std::function<void
    to disk or loaded into memory).
 
    The function is called repeatedly, depending on the size of the upload. Following middlewares will not be called
-   until the upload is finished.
+   until the upload is finished. The data points directly into the receive buffer and is only valid during the call,
+   it is not stored in the request body.
    \param req The Request object representing the matched request 
    \param data The current data block of the upload
    \param len The number of bytes of the current data block 
@@ -175,13 +194,16 @@ class Request
    friend class Server;
    friend class Response;
    friend class Middleware;
+   friend class Router;
 
    public:
 
       /*! \brief Constructs a new Response object
         \param req The underlying `libevhtp` request object 
+        \param arena The Arena backing the request's data. If NULL, the request uses an arena of its own
        */
-      explicit Request(evhtp_request* req);
+      explicit Request(evhtp_request* req, Arena* arena= nullptr);
+      ~Request();
 
      // base request info
 
@@ -195,6 +217,32 @@ class Request
 
       const char* getMiddlewarePath();   /*!< Returns the path of the currently matched Middleware */
 
+      Arena* getArena() const { return arena; }   /*!< \brief Returns the Arena backing the request's data (released with the request) */
+
+      // views (not NUL-terminated, converting to std::string_view with C++17)
+
+      StringView url() const;    /*!< \brief Returns the full URL of the request */
+      StringView path() const;   /*!< \brief Returns the path-portion of the URL of the request */
+      StringView host() const;   /*!< \brief Returns the hostname of the request (without port) */
+
+      /*! \brief Returns the value of a HTTP header, or an empty view if the header is not present
+        \param name Name of the HTTP header to retrieve */
+      StringView header(const char* name) const;
+
+      /*! \brief Returns the value of a well-known HTTP header, or an empty view if the header is not present
+        \param header The header to retrieve (e.g. `cex::hdr::Cookie`) */
+      StringView header(hdr::Header header) const;
+
+      // path parameters (fMatchPattern middlewares)
+
+      /*! \brief Returns the value of a path parameter captured by the currently matched `fMatchPattern` Middleware
+        \param name Name of the parameter as given in the pattern (without `:` or `*`)
+        \return A view into the request URL, or an empty view if there is no such parameter */
+      StringView getParam(const char* name) const;
+
+      /*! \brief Returns all path parameters captured by the currently matched `fMatchPattern` Middleware */
+      const RouteParams& getParams() const { return params; }
+
       // HTTP header related
 
       /*! \brief Iterates all HTTP headers of the request with the given callback function
@@ -206,6 +254,10 @@ class Request
         \param name Name of the HTTP header to retrieve */
       const char* get(const char* name);
 
+      /*! \brief Returns the value of a well-known HTTP header without scanning the header list
+        \param header The header to retrieve (e.g. `cex::hdr::Cookie`) */
+      const char* get(hdr::Header header);
+
       // URL query parameter related
 
       /*! \brief Iterates all URL query parameters of the request with the given callback function
@@ -219,24 +271,107 @@ class Request
 
       // request body
 
-      const char* getBody();     /*!< Returns the RAW body contents of the request  (unparsed, can be binary data)*/
+      /*! \brief Returns the RAW body contents of the request  (unparsed, can be binary data).
+
+        With Server::Config::zeroCopyBody, the body is kept in the receive buffer and linearized on the first call */
+      const char* getBody();
       size_t getBodyLength();    /*!< Returns the length of RAW body contents (number of bytes) */
 
+      /*! \brief Returns the RAW body contents as list of contiguous segments, without copying.
+
+        With Server::Config::zeroCopyBody, the segments point into the receive buffer, otherwise there is at most one segment.
+        The list is invalidated by the next call of bodySegments() or getBody(). */
+      const BodySegments& bodySegments();
+
+      // typed request-local storage (see Slot)
+
+      /*! \brief Returns the value stored in the slot of type `T`, or NULL if the slot is not set */
+      template<typename T, typename Tag= T>
+      T* slot() const
+      {
+         size_t index= Slot<T, Tag>::index();
+
+         return index < slotCount ? (T*)slots[index].value : nullptr;
+      }
+
+      /*! \brief Constructs the value of the slot of type `T` within the request's arena, replacing a previous value.
+        The value is destructed together with the request */
+      template<typename T, typename Tag= T, typename... Args>
+      T& emplaceSlot(Args&&... args)
+      {
+         SlotEntry& entry= slotEntry(Slot<T, Tag>::index());
+
+         clearSlot(entry);
+
+         T* value= arena->create<T>(std::forward<Args>(args)...);
+
+         entry.value= value;
+         entry.destroy= &destroySlot<T>;
+
+         return *value;
+      }
+
+      /*! \brief Destructs the value of the slot of type `T`, if any */
+      template<typename T, typename Tag= T>
+      void resetSlot()
+      {
+         size_t index= Slot<T, Tag>::index();
+
+         if (index < slotCount)
+            clearSlot(slots[index]);
+      }
+
       // CEX properties (sessionId, sslClientCert, ...)
 
       /*! \brief A list of properties of the current request
 
-        * Some properties are filled by `libcex`:
+        * Some properties are provided by `libcex`:
         \li `basicUsername` - The username, if the request was made with HTTP basic authentication
         \li `basicPassword` - The password, if the request was made with HTTP basic authentication
+        \li `sslClientCert` - The CertificateInfo of the client, if collected by \link cex::getSslClientInfo \endlink
         \li `[sessionid]` - The session ID of the current request. Its created by the \link cex::sessionHandler \endlink middleware function,
-        and the name of the property corresponds to the name of the cookie/sessionID as given in the middleware options */
+        and the name of the property corresponds to the name of the cookie/sessionID as given in the middleware options
+
+        The built-in middlewares store their results in typed slots (BasicCredentials, SessionInfo, CertificateInfo), which
+        should be preferred. The properties above are only copied into the list when they are first looked up. */
 
       PropertyList properties;
 
+      /*! \brief Materializes string-keyed properties from typed slots on first lookup. Returns `true` if the property `key` was set */
+      typedef bool (*PropertyShim)(Request* req, StringView key);
+
+      /*! \brief Registers a PropertyShim for all requests. Must be called during static initialization. At most 64 shims can be registered */
+      static bool registerPropertyShim(PropertyShim shim);
+
    private:
 
+      struct SlotEntry
+      {
+         void* value;
+         void (*destroy)(void*);
+      };
+
+      template<typename T>
+      static void destroySlot(void* value) { ((T*)value)->~T(); }
+
+      SlotEntry& slotEntry(size_t index);
+      static void clearSlot(SlotEntry& entry);
+      static bool resolveProperty(void* owner, StringView key);
+
+      enum ParseFlags
+      {
+         pfMethod= 0x01,
+         pfHost=   0x02,
+         pfUrl=    0x04,
+         pfPath=   0x08,
+         pfHeaders= 0x10
+      };
+
       void parse();
+      void parseMethod() const;
+      void parseHost() const;
+      void indexHeaders() const;
+      evhtp_kv_t* findHeader(const char* name) const;
 
       static int keyValueIteratorCb(evhtp_kv_t * kv, void * arg);
 
@@ -244,13 +379,135 @@ class Request
       evhtp_path_t* uri;
       evhtp_authority_t* authority;
 
+      std::unique_ptr<Arena> ownArena;
+      Arena* arena;
+
       int evhtp_method;
-      int port;
-      std::string host;
-      Method method;
-      Protocol protocol;
-      std::string middlewarePath;
-      std::vector<char> body;
+      mutable unsigned parsed;        // ParseFlags of the fields parsed so far
+      mutable int port;
+      mutable const char* hostName;   // owned by libevhtp or allocated from the arena
+      mutable size_t hostLength;
+      mutable Method method;
+      mutable Protocol protocol;
+      mutable size_t urlLength;
+      mutable size_t pathLength;
+      mutable evhtp_kv_t* headers[hdr::count];     // well-known headers (first occurrence)
+      const char* middlewarePath;     // owned by the Middleware
+      RouteParams params;
+      std::vector<char, ArenaAllocator<char>> body;
+      struct evbuffer* bodyBuffer;    // receive buffer holding the body (zeroCopyBody), owned by libevhtp
+      BodySegments segments;
+      SlotEntry* slots;               // allocated from the arena
+      size_t slotCount;
+      unsigned long long shimsDone;
+};
+
+//***************************************************************************
+// class HeaderBlock
+//***************************************************************************
+/*! \class HeaderBlock
+  \brief A constant set of HTTP headers which is built once and attached to many responses.
+
+  Attaching a block with Response::set(const HeaderBlock&) does not copy the names and values,
+  so the block must outlive all responses it is attached to, and must not be modified in the meantime.
+
+Example:
+```
+   static const cex::HeaderBlock jsonHeaders({ { "Content-Type", "application/json" },
+                                               { "Cache-Control", "no-store" } });
+
+   app.get("/api", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+   {
+      res->set(jsonHeaders);
+      res->end("{}", 200);
+   });
+```
+*/
+
+class HeaderBlock
+{
+   friend class Response;
+
+   public:
+
+      HeaderBlock() {}
+
+      /*! \brief Constructs a block from a list of name/value pairs */
+      HeaderBlock(std::initializer_list<std::pair<const char*, const char*>> headers);
+
+      /*! \brief Adds a header to the block. Must not be called while the block is attached to responses */
+      void add(const std::string& name, const std::string& value) { headers.emplace_back(name, value); }
+
+      size_t size() const { return headers.size(); }     /*!< \brief Returns the number of headers */
+      bool empty() const { return headers.empty(); }     /*!< \brief Returns `true` if the block contains no headers */
+
+   private:
+
+      std::vector<std::pair<std::string, std::string>> headers;
+};
+
+//***************************************************************************
+// class ResponseBuilder
+//***************************************************************************
+/*! \class ResponseBuilder
+  \brief Assembles a response payload from several fragments without concatenating them.
+
+  Shared and owned fragments are referenced by the builder's buffer chain, which is handed over
+  to the connection when the response is sent (see Response::end(ResponseBuilder&&, int)).
+
+Example:
+```
+   static std::shared_ptr<const cex::Buffer> header= loadFragment("header.html");
+   static std::shared_ptr<const cex::Buffer> footer= loadFragment("footer.html");
+
+   app.get("/page", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+   {
+      cex::ResponseBuilder page;
+
+      page.append(header).append(renderBody(req)).append(footer);
+
+      res->end(std::move(page), 200);
+   });
+```
+*/
+
+class ResponseBuilder
+{
+   friend class Response;
+
+   public:
+
+      ResponseBuilder();
+      ResponseBuilder(ResponseBuilder&& other);
+      ~ResponseBuilder();
+
+      ResponseBuilder(const ResponseBuilder&) = delete;
+      ResponseBuilder& operator=(const ResponseBuilder&) = delete;
+
+      /*! \brief Appends a shared fragment without copying it. The fragment is referenced until the response was sent */
+      ResponseBuilder& append(std::shared_ptr<const Buffer> fragment);
+
+      /*! \brief Appends a string, taking it over without copying */
+      ResponseBuilder& append(std::string&& part);
+
+      /*! \brief Appends a copy of `len` bytes of `data` */
+      ResponseBuilder& append(const char* data, size_t len);
+
+      /*! \brief Appends `len` bytes of `data` without copying. The data must stay valid and unmodified until the response was sent (e.g. string literals) */
+      ResponseBuilder& appendStatic(const char* data, size_t len);
+
+      /*! \brief Appends a region of a file without copying it into the builder. The region is mapped with `mmap`
+        (or read into memory, where mapping is unavailable) as the builder's buffer does not drain to a socket, so
+        unlike Response::sendFile(), it is **not** sent with `sendfile`. The descriptor is duplicated, the caller keeps
+        ownership of `fd` */
+      ResponseBuilder& appendFile(int fd, off_t offset, size_t len);
+
+      /*! \brief Returns the number of bytes appended so far */
+      size_t size() const;
+
+   private:
+
+      struct evbuffer* chain;
 };
 
 //***************************************************************************
@@ -301,6 +558,7 @@ class Response
         \param req The underlying `libevhtp` request object 
        */
       explicit Response(evhtp_request* req);
+      ~Response();
 
       /*! \brief Sets a HTTP header to a given value
         \param name Name of the HTTP header
@@ -314,6 +572,18 @@ class Response
         */
       void set(const char* name, int value);
 
+      /*! \brief Sets a HTTP header without copying name and value. Both must stay valid until the response
+        is finished (e.g. string literals)
+        \param name Name of the HTTP header
+        \param value The value which shall be set
+        */
+      void setStatic(const char* name, const char* value);
+
+      /*! \brief Sets all HTTP headers of a HeaderBlock without copying them (see HeaderBlock)
+        \param headers The headers which shall be set
+        */
+      void set(const HeaderBlock& headers);
+
       /*! \brief Sends a response to the client with the supplied HTTP code and payload text
        \param string The text which shall be sent to the client in the response body.
        \param status The HTTP code which shall be sent to the client.
@@ -327,6 +597,42 @@ class Response
        */
       int end(const char* buffer, size_t bufLen, int status);
 
+      /*! \brief Sends a response to the client with the supplied HTTP code, taking over the string as payload without copying
+       \param string The text which shall be sent to the client in the response body (without terminating zero).
+       \param status The HTTP code which shall be sent to the client.
+       */
+      int end(std::string&& string, int status);
+
+      /*! \brief Sends a response to the client with the supplied HTTP code, taking over the buffer as payload without copying
+       \param buffer The data which shall be sent to the client in the response body.
+       \param status The HTTP code which shall be sent to the client.
+       */
+      int end(std::vector<char>&& buffer, int status);
+
+      /*! \brief Sends a response to the client with the supplied HTTP code and a shared payload without copying it.
+
+       The response keeps a reference to the buffer until it was sent, so the same buffer (e.g. a cached JSON document)
+       can be sent to any number of clients.
+       \param buffer The data which shall be sent to the client in the response body.
+       \param status The HTTP code which shall be sent to the client.
+       */
+      int end(std::shared_ptr<const Buffer> buffer, int status);
+
+      /*! \brief Sends a response to the client with the supplied HTTP code and a payload consisting of several parts
+       \param parts The parts which shall be sent in the response body, in order. They are copied, so they may be released afterwards.
+       \param n The number of parts.
+       \param status The HTTP code which shall be sent to the client.
+
+       The parts are not concatenated beforehand (also not for compression).
+       */
+      int end(const struct iovec* parts, size_t n, int status);
+
+      /*! \brief Sends a response to the client with the supplied HTTP code and the fragments of the builder as payload.
+       \param builder The fragments which shall be sent. Referenced fragments are handed to the connection without copying.
+       \param status The HTTP code which shall be sent to the client.
+       */
+      int end(ResponseBuilder&& builder, int status);
+
       /*! \brief Sends a response to the client with the supplied HTTP code and no body/payload
        \param status The HTTP code which shall be sent to the client.
        */
@@ -338,9 +644,49 @@ class Response
        \return `cex::success` (0) if the whole contents were successfully transferred or `cex::fail` (-1) if the stream could not be read.
       
        This function is useful for transferring larger payloads (e.g. files) which shall not be fully loaded into memory.
+       The whole stream is read at once though, so the connection's output buffer may grow up to the size of the
+       contents for slow clients. Prefer the owning overload for large contents.
        */
       int stream(int status, std::istream* stream);
 
+      /*! \brief Streams a response to the client with the supplied HTTP code, taking over the stream
+       \param status The HTTP code which shall be sent to the client.
+       \param stream The stream which is used to read the response contents from. It is released once all contents were sent.
+       \return `cex::done` if the response was started or `cex::fail` if the stream could not be read.
+
+       Streaming pauses whenever the connection's output buffer exceeds the stream watermark (see setStreamWatermark()),
+       and resumes once the client has received half of it, so the memory used per connection stays bounded regardless of the
+       speed of the client. The response is in `stDone` state when this function returns, the remaining contents are sent
+       from the event loop.
+       */
+      int stream(int status, std::unique_ptr<std::istream> stream);
+
+      /*! \brief Suspends the request, so it can be completed asynchronously (e.g. from a worker thread).
+       \return The handle used to complete the request, or NULL if the response was already sent.
+
+       The middleware returns without ending the response (and without calling `next()`). The request stays
+       paused until a function posted via the handle ended the response. Once suspended, the request/response
+       must only be accessed through the handle (see AsyncHandle). Calling suspend() again returns the same handle.
+       */
+      AsyncHandlePtr suspend();
+
+      /*! \brief Sets the high watermark (in bytes) of the connection's output buffer for streamed responses.
+        0 disables the watermark (the whole stream is read at once). Defaults to Server::Config::streamWatermark */
+      void setStreamWatermark(size_t bytes) { watermark= bytes; }
+
+      /*! \brief Sends a region of a file to the client with an exact `Content-Length`, without copying it through user space
+       \param fd The file descriptor of the file. The response takes ownership and closes it after the data was sent (or on error).
+       \param offset The offset of the first byte within the file which shall be sent.
+       \param len The number of bytes which shall be sent.
+       \param status The HTTP code which shall be sent to the client.
+       \return `cex::done` if the response was sent or `cex::fail` if the file could not be opened as a file segment.
+
+       On plain connections the file is sent using `sendfile`. TLS connections (and systems without `sendfile`) map
+       the region with `mmap` or read it into memory, as the data must be encrypted. The contents are sent as they
+       are, the compression flags are **not** applied. `HEAD` requests only receive the headers.
+       */
+      int sendFile(int fd, off_t offset, size_t len, int status= EVHTP_RES_OK);
+
       /*! \brief Queries the state of the response.
         \param aState The state which shall be compared to the response object state
         \return `true` if the state of the object matches the supplied state, otherwise `false`.
@@ -365,9 +711,22 @@ class Response
       int getFlags() const { return flags; };
 
    private:
+
+      typedef void (*ReleaseFunction)(const void* data, size_t len, void* owner);
+
+      int endReference(const char* data, size_t len, ReleaseFunction release, void* owner, int status);
+
+      struct StreamState;
+
+      static evhtp_res handleWrite(evhtp_connection_t* conn, void* arg);
+      void pump();
+      void stopStreaming();
+
       evhtp_request* req;
       State state;
       int flags;
+      size_t watermark;
+      std::unique_ptr<StreamState> streaming;
 };
 
 //***************************************************************************
@@ -488,6 +847,29 @@ typedef std::function<void(const WebSocket& ws)> WebSocketCloseFunction;
 typedef std::function<void(const WebSocket& ws, const char* error)> WebSocketErrorFunction;
 #endif
 
+//***************************************************************************
+// struct MiddlewareStats
+//***************************************************************************
+/*! \struct MiddlewareStats
+  \brief Snapshot of the statistics of a single middleware (see Server::Config::collectMiddlewareStats).
+
+  The time of an invocation is measured from calling the middleware function until it calls `next()`
+  or returns, whichever happens first.
+  */
+
+struct MiddlewareStats
+{
+   static const int bucketCount= 24;
+
+   std::string path;                   /*!< \brief Path of the middleware */
+   size_t index;                       /*!< \brief Registration index of the middleware */
+   int method;                         /*!< \brief HTTP method of the middleware (`na` if method-agnostic) */
+   unsigned long long matches;         /*!< \brief Number of requests the middleware matched */
+   unsigned long long invocations;     /*!< \brief Number of calls of the middleware function */
+   unsigned long long totalMicros;     /*!< \brief Summed up time of all invocations in microseconds */
+   unsigned long long histogram[bucketCount];   /*!< \brief Bucket `i` counts invocations shorter than 2^i microseconds (the last bucket all longer ones) */
+};
+
 //***************************************************************************
 // class Middleware
 //***************************************************************************
@@ -499,6 +881,7 @@ typedef std::function<void(const WebSocket& ws, const char* error)> WebSocketErr
 class Middleware
 {
    friend class Server;
+   friend class Router;
 
    public:
 
@@ -508,6 +891,7 @@ class Middleware
          fMatchContain= 0x001,  /*!< Match if the request's URL contains the Middleware path */
          fMatchCompare= 0x002,  /*!< Match if the request's URL equals the Middleware path */
          fMatchRegex=   0x004,  /*!< Perform a regular expression match with the Middleware path as pattern */
+         fMatchPattern= 0x008,  /*!< Match the URL against a path pattern with parameters, e.g. `/users/:id` (see PathPattern) */
          fMatching=     0x00F
       };
 
@@ -531,13 +915,27 @@ class Middleware
 
    private:
 
+      struct Stats;
+
+      void init(const char* aPath);
+      void bind(Request* req) const;
+      bool matchMethod(Request* req) const;
+
+      void enableStats();
+      void countMatch() const;
+      void countInvocation(unsigned long long micros) const;
+      void getStats(MiddlewareStats& result) const;
+
       int type;
       int method;
       int flags;
       std::regex rep;
+      PathPattern pattern;
       std::string path;
       MiddlewareFunction func;
       UploadFunction uploadFunc;
+      size_t maxBodySize;              // body limit (see Server::maxBodySize)
+      std::shared_ptr<Stats> stats;    // only allocated if statistics are collected
 };
 
 //***************************************************************************
@@ -551,18 +949,78 @@ class Server
 {
    public:
 
+      struct Context;
+
+      /*! \struct Routes
+        \brief Immutable snapshot of the attached middlewares and the router built from them.
+
+        Registering or removing middlewares never modifies a snapshot which is in use. Instead, a new
+        snapshot is published: once when the server starts (for all middlewares registered until then),
+        and afterwards by each registering call. Each request keeps a reference to the snapshot it was
+        started with, the old snapshot is released with its last request (and the worker threads' caches).
+       */
+
+      struct Routes
+      {
+         std::vector<std::shared_ptr<Middleware>> middleWares;
+         std::vector<std::shared_ptr<Middleware>> uploadWares;
+         std::vector<std::shared_ptr<Middleware>> limitWares;
+         Router router;
+      };
+
+      typedef std::shared_ptr<const Routes> RoutesPtr;
+
+      /*! \struct Dispatcher
+        \brief Internal helper struct which runs the middleware chain of a request.
+
+        The dispatcher keeps a cursor into the chain. Its `next` function (handed to each
+        middleware) advances the cursor in a loop and calls the next middleware, so the
+        chain does not need to be walked recursively. As the dispatcher lives in the request
+        Context, `next()` may also be called after the middleware function has returned.
+       */
+
+      struct Dispatcher
+      {
+         explicit Dispatcher(Context* ctx);
+
+         void dispatch(size_t from);
+         void finish();
+
+         Context* ctx;
+         size_t cursor;
+         size_t timed;                                     // middleware currently timed (statistics), or none
+         std::chrono::steady_clock::time_point started;
+         std::function<void()> next;
+      };
+
       /*! \struct Context
         \brief Internal helper struct for handling libevhtp callback functions
+
+        The context is allocated from a per-request Arena, which is released as a whole when
+        the request is finished. The request/response pointers must not be kept beyond that.
        */
 
       struct Context
       {
-         Context(evhtp_request_t* request, Server* serv)
-            : req(new Request(request)), res(new Response(request)), serv(serv) {}
-
+         Context(evhtp_request_t* request, Server* serv, Arena* arena)
+            : arena(arena),
+              req(std::allocate_shared<Request>(ArenaAllocator<Request>(arena), request, arena)),
+              res(std::allocate_shared<Response>(ArenaAllocator<Response>(arena), request)),
+              serv(serv), routes(serv->getRoutes()), upload(nullptr), maxBodySize(0), bodySize(0), bodyTooLarge(false),
+              dispatcher(this) {}
+
+         Arena* arena;              // backs the context itself, request, response and their data
          ReqPtr req;
          ResPtr res;
          Server* serv;
+         RoutesPtr routes;
+         Middleware* upload;        // upload middleware matching the request (resolved once in handleHeaders)
+         AsyncHandlePtr async;      // handle of a suspended request (see Response::suspend)
+         size_t maxBodySize;        // body limit of the request (0 = unlimited)
+         size_t bodySize;           // body bytes received so far
+         bool bodyTooLarge;         // body exceeds the limit, answered with 413
+         std::vector<Middleware*> chain;
+         Dispatcher dispatcher;
       };
 
       /*! \struct Config
@@ -588,6 +1046,24 @@ class Server
                                   This tries to extract the SSL certificate provided by the client and store it into a CertificateInfo structure within the requests `sslClientCert` property. */
          bool sslEnabled;       /*!< \brief Flag indicating whether or not SSL is enabled on the listener (default: false). */
          int threadCount;       /*!< \brief Controls the number of worker threads the server is going to use (default: 4). */
+         bool collectMiddlewareStats; /*!< \brief Record per-middleware statistics (matches, invocations, time histogram) (default: false).
+
+                                  See Server::middlewareStats(). Applies to middlewares attached after construction of the server. */
+         size_t routeCacheSize; /*!< \brief Maximum number of resolved routes (method + path) cached per worker thread (default: 0, cache disabled).
+
+                                  Adding middlewares or calling Server::reset() invalidates the cache. See Server::getRouteCacheStats(). */
+         bool zeroCopyBody;     /*!< \brief Keep request bodies in the receive buffer instead of copying them into the request (default: false).
+
+                                  Request::bodySegments() then returns the buffer's segments, and Request::getBody() only copies
+                                  if the body is spread across several segments. Does not affect upload middlewares. */
+         size_t maxBodySize;    /*!< \brief Maximum size of request bodies in bytes (default: 0, unlimited).
+
+                                  Requests announcing a larger `Content-Length` are answered with 413 (closing the connection), their body is discarded without buffering it.
+                                  Bodies without `Content-Length` are discarded as soon as they exceed the limit. Can be overridden per route
+                                  with Server::maxBodySize(). */
+         size_t streamWatermark; /*!< \brief High watermark of the output buffer for streamed responses in bytes (default: 512 KB).
+
+                                  Response::stream() pauses reading the stream while more data is waiting to be sent to the client. 0 disables the watermark. */
 
 #ifdef CEX_WITH_SSL
          int sslVerifyMode;
@@ -623,8 +1099,22 @@ class Server
 
       // router
 
-      /*! \brief Removes all attached middlewares */
-      void reset() { middleWares.clear(); }
+      /*! \brief Removes all attached middlewares. May be called while the server is running. */
+      void reset();
+
+      /*! \brief Returns the current snapshot of the attached middlewares.
+
+        Each thread caches the snapshot it has seen last, so unless the middlewares changed, this is a single atomic load
+        without locking. */
+      RoutesPtr getRoutes();
+
+      /*! \brief Returns the statistics of all attached middlewares, ordered by registration index.
+
+        Statistics are only recorded if Config::collectMiddlewareStats is set. */
+      std::vector<MiddlewareStats> middlewareStats();
+
+      /*! \brief Returns the hit/miss counters of the route cache (see Config::routeCacheSize) since the last change of the middlewares */
+      Router::CacheStats getRouteCacheStats() { return getRoutes()->router.getCacheStats(); }
 
       /*! \brief Attaches a middleware function with no conditions
         
@@ -885,6 +1375,14 @@ class Server
          \param flags Flags controlling the URL matching behaviour (see Middleware)*/
       void uploads(const char* path, const UploadFunction& func, Method method= methodPOST, int flags= Middleware::fMatchContain);
 
+      /*! \brief Overrides Config::maxBodySize for requests matching the given URL path
+
+         The first matching path (in order of registration) applies. Larger request bodies are answered with 413.
+         \param path The URL path which shall be compared against the request URL
+         \param size Maximum body size in bytes (0 = unlimited)
+         \param flags Flags controlling the URL matching behaviour (see Middleware)*/
+      void maxBodySize(const char* path, size_t size, int flags= Middleware::fMatchContain);
+
 #ifdef EVHTP_WS_SUPPORT
       // WebSocket support
 
@@ -920,6 +1418,9 @@ class Server
    private:
 
       int start(bool block);
+      void routesChanged();
+      void publishRoutes();
+      void attach(const char* path, const MiddlewareFunction& func, int method, int flags);
 
       static int initMimeTypes();
 
@@ -934,8 +1435,17 @@ class Server
 
       // members
 
-      std::vector<std::unique_ptr<Middleware>> middleWares;
-      std::vector<std::unique_ptr<Middleware>> uploadWares;
+      // middlewares as registered (guarded by routesMutex). published as Routes snapshots
+
+      std::mutex routesMutex;
+      std::vector<std::shared_ptr<Middleware>> middleWares;
+      std::vector<std::shared_ptr<Middleware>> uploadWares;
+      std::vector<std::shared_ptr<Middleware>> limitWares;
+      std::atomic<unsigned long long> routesVersion;   // bumped with each published snapshot
+      RoutesPtr published;              // current snapshot
+      bool routesDirty;                 // registrations not published yet
+      bool routesLive;                  // server started, publish each change right away
+      unsigned long long instance;
 
 #ifdef EVHTP_WS_SUPPORT
       struct WebSocketHandler
@@ -1001,9 +1511,97 @@ class Server
 
       static bool initialized;
       static std::mutex initMutex;
+      static std::atomic<unsigned long long> instances;
       static std::unique_ptr<MimeTypes> mimeTypes;
 };
 
+//***************************************************************************
+// class AsyncHandle
+//***************************************************************************
+/*! \class AsyncHandle
+  \brief Completes a suspended request from any thread (see Response::suspend()).
+
+  All functions of the handle may be called from any thread. They are marshalled to the event
+  loop owning the request and executed there, so the middleware chain never blocks a worker thread
+  of the server while waiting for e.g. a database.
+
+  If the request was finished in the meantime (e.g. the client closed the connection), posted functions are dropped.
+
+Example:
+```
+   app.get("/report", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+   {
+      cex::AsyncHandlePtr handle= res->suspend();
+
+      pool.submit([handle]()
+      {
+         std::string report= buildReport();      // takes a while
+
+         handle->end(std::move(report), 200);
+      });
+   });
+```
+  */
+
+class AsyncHandle : public std::enable_shared_from_this<AsyncHandle>
+{
+   friend class Response;
+   friend class Server;
+
+   public:
+
+      /*! \brief Runs a function with the request/response on the thread owning the request
+        \return `false` if the request is already finished or the function could not be scheduled */
+      bool post(MiddlewareFunction func);
+
+      /*! \brief Runs a function with the request/response on the thread owning the request after the given delay
+        \return `false` if the request is already finished or the function could not be scheduled */
+      bool postDelayed(MiddlewareFunction func, std::chrono::milliseconds delay);
+
+      /*! \brief Sends a response with the supplied HTTP code and no body/payload (see Response::end()) */
+      bool end(int status);
+
+      /*! \brief Sends a response with the supplied HTTP code, taking over the string as payload (see Response::end()) */
+      bool end(std::string&& string, int status);
+
+      /*! \brief Continues with the next middleware of the request */
+      bool next();
+
+      /*! \brief Returns `false` once the request is finished. A `true` result may already be outdated when it is returned */
+      bool isAlive() const { return alive; }
+
+      /*! \brief Calls `func(req, arg)` after the given delay. Must be called on the thread owning the request.
+
+        Unlike postDelayed(), this does not allocate: the handle owns a single timer, created on first use. Only one
+        call can be pending at a time.
+        \return `false` if the request is already finished or another call is pending */
+      bool callLater(std::chrono::milliseconds delay, void (*func)(Request* req, void* arg), void* arg);
+
+      ~AsyncHandle();
+
+   private:
+
+      struct Call;
+
+      AsyncHandle(Server::Context* ctx, evhtp_request* req);
+
+      bool schedule(MiddlewareFunction func, const struct timeval* delay);
+      void finishCall();
+      void stopTimer();
+
+      static void handleCall(evutil_socket_t fd, short what, void* arg);
+      static void handleTimer(evutil_socket_t fd, short what, void* arg);
+
+      Server::Context* ctx;
+      evhtp_request* req;
+      struct event_base* base;
+      std::atomic<bool> alive;   // cleared when the request is finished (on the owning thread)
+      bool paused;               // request paused (owning thread only)
+      struct event* timer;       // callLater() (owning thread only)
+      void (*timerFunc)(Request* req, void* arg);
+      void* timerArg;
+};
+
 //***************************************************************************
 } // namespace cex
 
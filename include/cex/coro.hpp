@@ -0,0 +1,545 @@
+//*************************************************************************
+// File coro.hpp
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// Coroutine based middlewares (C++20)
+//*************************************************************************
+
+#ifndef __CORO_HPP__
+#define __CORO_HPP__
+
+/*! \file coro.hpp
+  \brief Coroutine based middlewares (C++20)
+
+  Header-only, available if the including code is compiled with coroutine support (`CEX_WITH_COROUTINES`
+  is defined then). The library itself does not need to be built with C++20.
+
+Example:
+```
+   app.get("/report", cex::coroutine([](cex::Request* req, cex::Response* res, cex::Next next) -> cex::Task<>
+   {
+      co_await cex::delay(std::chrono::milliseconds(10));
+
+      std::string report= co_await cex::offload([]() { return buildReport(); });
+
+      res->end(std::move(report), 200);
+   }));
+```
+  All coroutines of a request run on the thread owning the request. Awaiting a timer or an offloaded job
+  suspends the request (see Response::suspend()) and resumes the coroutine on the request's event loop.
+  The coroutine frames are allocated from the request's Arena and destructed together with the request,
+  even if the coroutine did not complete (e.g. the client closed the connection).
+
+  Awaiting a delay reuses a single timer of the request's AsyncHandle (allocated with the first suspension).
+  Offloading a job to another thread allocates its shared state and the executor's job function.
+ */
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include "core.hpp"
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#  if __has_include(<coroutine>)
+#     define CEX_WITH_COROUTINES 1
+#  endif
+#endif
+
+#ifdef CEX_WITH_COROUTINES
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cex
+{
+
+template<typename T= void> class Task;
+class Next;
+
+namespace detail
+{
+
+//***************************************************************************
+// frame allocation
+//***************************************************************************
+
+// arena of the request whose coroutine currently runs on this thread. frames created
+// meanwhile (including nested tasks) are allocated from it
+
+inline Arena*& currentArena()
+{
+   static thread_local Arena* arena= nullptr;
+   return arena;
+}
+
+struct ArenaScope
+{
+   explicit ArenaScope(Arena* arena) : previous(currentArena()) { currentArena()= arena; }
+   ~ArenaScope() { currentArena()= previous; }
+
+   ArenaScope(const ArenaScope&) = delete;
+   ArenaScope& operator=(const ArenaScope&) = delete;
+
+   Arena* previous;
+};
+
+// each frame is prefixed with the arena it came from (NULL: heap)
+
+static const size_t frameHeaderSize= (sizeof(Arena*) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+//***************************************************************************
+// PromiseBase
+//***************************************************************************
+
+struct PromiseBase
+{
+   static void* operator new(size_t size)
+   {
+      Arena* arena= currentArena();
+      void* p= arena ? arena->allocate(size + frameHeaderSize) : ::operator new(size + frameHeaderSize);
+
+      *(Arena**)p= arena;
+
+      return (char*)p + frameHeaderSize;
+   }
+
+   static void operator delete(void* frame, size_t size)
+   {
+      void* p= (char*)frame - frameHeaderSize;
+      Arena* arena= *(Arena**)p;
+
+      if (arena)
+         arena->deallocate(p, size + frameHeaderSize);
+      else
+         ::operator delete(p);
+   }
+
+   // completing a task resumes the coroutine awaiting it. an exception leaving the outermost
+   // task of a middleware answers the request with 500
+
+   struct FinalAwaiter
+   {
+      bool await_ready() noexcept { return false; }
+
+      template<typename Promise>
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> coro) noexcept
+      {
+         PromiseBase& promise= coro.promise();
+
+         if (promise.continuation)
+            return promise.continuation;
+
+         if (promise.exception && promise.response && promise.response->isPending())
+            promise.response->end(500);
+
+         return std::noop_coroutine();
+      }
+
+      void await_resume() noexcept {}
+   };
+
+   std::suspend_always initial_suspend() noexcept { return {}; }
+   FinalAwaiter final_suspend() noexcept { return {}; }
+   void unhandled_exception() { exception= std::current_exception(); }
+
+   std::coroutine_handle<> continuation;
+   Request* request= nullptr;
+   Response* response= nullptr;
+   std::exception_ptr exception;
+};
+
+template<typename T>
+struct Promise : PromiseBase
+{
+   Task<T> get_return_object();
+
+   template<typename U>
+   void return_value(U&& value) { result.emplace(std::forward<U>(value)); }
+
+   T get()
+   {
+      if (exception)
+         std::rethrow_exception(exception);
+
+      return std::move(*result);
+   }
+
+   std::optional<T> result;
+};
+
+template<>
+struct Promise<void> : PromiseBase
+{
+   Task<void> get_return_object();
+
+   void return_void() {}
+
+   void get()
+   {
+      if (exception)
+         std::rethrow_exception(exception);
+   }
+};
+
+//***************************************************************************
+// resumption on the request's event loop
+//***************************************************************************
+
+// returns false if the request cannot be suspended (response already sent), the
+// coroutine then continues right away. the handle's timer is reused, so awaiting a delay
+// does not allocate (unless another coroutine of the request is waiting for a delay as well)
+
+inline void resumeCoroutine(Request* req, void* address)
+{
+   ArenaScope scope(req->getArena());
+   std::coroutine_handle<>::from_address(address).resume();
+}
+
+inline bool resumeLater(PromiseBase& promise, std::coroutine_handle<> coro, std::chrono::milliseconds delay)
+{
+   AsyncHandlePtr handle= promise.response ? promise.response->suspend() : nullptr;
+
+   if (!handle)
+      return false;
+
+   if (handle->callLater(delay, &resumeCoroutine, coro.address()))
+      return true;
+
+   return handle->postDelayed([coro](Request* req, Response* res, const std::function<void()>& next)
+   {
+      resumeCoroutine(req, coro.address());
+   }, delay);
+}
+
+// outcome of an offloaded job
+
+template<typename T>
+struct Outcome
+{
+   template<typename F>
+   void run(F& job)
+   {
+      try { value.emplace(job()); }
+      catch (...) { error= std::current_exception(); }
+   }
+
+   T get()
+   {
+      if (error)
+         std::rethrow_exception(error);
+
+      return std::move(*value);
+   }
+
+   std::optional<T> value;
+   std::exception_ptr error;
+};
+
+template<>
+struct Outcome<void>
+{
+   template<typename F>
+   void run(F& job)
+   {
+      try { job(); }
+      catch (...) { error= std::current_exception(); }
+   }
+
+   void get()
+   {
+      if (error)
+         std::rethrow_exception(error);
+   }
+
+   std::exception_ptr error;
+};
+
+// tasks of a request which did not complete synchronously
+
+struct CoroutineFrames
+{
+   std::vector<Task<void>> tasks;
+};
+
+} // namespace detail
+
+//***************************************************************************
+// class Task
+//***************************************************************************
+/*! \class Task
+  \brief Coroutine type of coroutine middlewares and the coroutines awaited by them.
+
+  A task starts when it is awaited (or when the middleware is called), and resumes the awaiting
+  coroutine when it completes. Exceptions are rethrown in the awaiting coroutine.
+  */
+
+template<typename T>
+class Task
+{
+   template<typename> friend struct detail::Promise;
+   friend MiddlewareFunction coroutine(std::function<Task<void>(Request*, Response*, Next)> func);
+
+   public:
+
+      typedef detail::Promise<T> promise_type;
+
+      Task() {}
+      Task(Task&& other) noexcept : coro(std::exchange(other.coro, nullptr)) {}
+      ~Task() { reset(); }
+
+      Task& operator=(Task&& other) noexcept
+      {
+         if (this != &other)
+         {
+            reset();
+            coro= std::exchange(other.coro, nullptr);
+         }
+
+         return *this;
+      }
+
+      /*! \brief Returns `true` if the task completed (or is empty) */
+      bool done() const { return !coro || coro.done(); }
+
+      bool await_ready() const noexcept { return !coro; }
+
+      template<typename Promise>
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) noexcept
+      {
+         promise_type& promise= coro.promise();
+
+         promise.continuation= awaiting;
+         promise.request= awaiting.promise().request;
+         promise.response= awaiting.promise().response;
+
+         return coro;
+      }
+
+      T await_resume() { return coro.promise().get(); }
+
+   private:
+
+      explicit Task(std::coroutine_handle<promise_type> coro) : coro(coro) {}
+
+      void start(Request* req, Response* res)
+      {
+         coro.promise().request= req;
+         coro.promise().response= res;
+         coro.resume();
+      }
+
+      void reset()
+      {
+         if (coro)
+            coro.destroy();
+
+         coro= nullptr;
+      }
+
+      std::coroutine_handle<promise_type> coro;
+};
+
+template<typename T>
+inline Task<T> detail::Promise<T>::get_return_object() { return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this)); }
+
+inline Task<void> detail::Promise<void>::get_return_object() { return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this)); }
+
+//***************************************************************************
+// class Next
+//***************************************************************************
+/*! \class Next
+  \brief The `next` function handed to coroutine middlewares.
+
+  `co_await next()` runs the next middlewares of the request and continues as soon as they returned
+  (or suspended the request). Calling `next()` without `co_await` has the same effect.
+  */
+
+class Next
+{
+   public:
+
+      explicit Next(const std::function<void()>& next) : next(&next) {}
+
+      std::suspend_never operator()() const
+      {
+         (*next)();
+         return {};
+      }
+
+   private:
+
+      const std::function<void()>* next;   // lives in the request context
+};
+
+/*! \brief Function type of coroutine middlewares */
+typedef std::function<Task<void>(Request* req, Response* res, Next next)> CoroutineFunction;
+
+//***************************************************************************
+// coroutine (middleware adapter)
+//***************************************************************************
+/*! \public
+  \brief Creates a MiddlewareFunction which runs the given coroutine function.
+
+  The coroutine starts immediately. If it does not complete synchronously, its frame is kept
+  with the request until the request is finished.
+  */
+
+inline MiddlewareFunction coroutine(CoroutineFunction func)
+{
+   return [func](Request* req, Response* res, const std::function<void()>& next)
+   {
+      detail::ArenaScope scope(req->getArena());
+
+      Task<void> task= func(req, res, Next(next));
+
+      if (task.done())
+         return;
+
+      task.start(req, res);
+
+      if (task.done())
+         return;
+
+      detail::CoroutineFrames* frames= req->slot<detail::CoroutineFrames>();
+
+      if (!frames)
+         frames= &req->emplaceSlot<detail::CoroutineFrames>();
+
+      frames->tasks.push_back(std::move(task));
+   };
+}
+
+//***************************************************************************
+// awaitables
+//***************************************************************************
+/*! \class Delay
+  \brief Awaitable timer, see delay() */
+
+class Delay
+{
+   public:
+
+      explicit Delay(std::chrono::milliseconds duration) : duration(duration) {}
+
+      bool await_ready() const noexcept { return duration.count() <= 0; }
+
+      template<typename Promise>
+      bool await_suspend(std::coroutine_handle<Promise> coro) { return detail::resumeLater(coro.promise(), coro, duration); }
+
+      void await_resume() const noexcept {}
+
+   private:
+
+      std::chrono::milliseconds duration;
+};
+
+/*! \public
+  \brief Returns an awaitable which resumes the coroutine on the request's event loop after the given duration.
+  Once the response was sent, the coroutine continues without waiting. */
+
+template<typename Rep, typename Period>
+Delay delay(std::chrono::duration<Rep, Period> duration)
+{
+   return Delay(std::chrono::duration_cast<std::chrono::milliseconds>(duration));
+}
+
+/*! \brief Runs a function on some other thread (e.g. the `submit` function of a thread pool) */
+typedef std::function<void(std::function<void()>)> Executor;
+
+/*! \brief Executor running each job in a new (detached) thread */
+inline void threadExecutor(std::function<void()> job)
+{
+   std::thread(std::move(job)).detach();
+}
+
+/*! \class Offload
+  \brief Awaitable job running on another thread, see offload() */
+
+template<typename F>
+class Offload
+{
+   public:
+
+      typedef decltype(std::declval<F&>()()) Result;
+
+      Offload(F job, Executor executor) : state(std::make_shared<State>(std::move(job))), executor(std::move(executor)) {}
+
+      bool await_ready() const noexcept { return false; }
+
+      template<typename Promise>
+      bool await_suspend(std::coroutine_handle<Promise> coro)
+      {
+         AsyncHandlePtr handle= coro.promise().response ? coro.promise().response->suspend() : nullptr;
+
+         // response already sent: run the job right away
+
+         if (!handle)
+         {
+            state->outcome.run(state->job);
+            return false;
+         }
+
+         // the state is shared with the job, as the frame is gone if the request finishes meanwhile
+
+         std::shared_ptr<State> jobState= state;
+         std::coroutine_handle<> awaiting= coro;
+
+         executor([jobState, handle, awaiting]()
+         {
+            jobState->outcome.run(jobState->job);
+
+            handle->post([awaiting](Request* req, Response* res, const std::function<void()>& next)
+            {
+               detail::ArenaScope scope(req->getArena());
+               awaiting.resume();
+            });
+         });
+
+         return true;
+      }
+
+      Result await_resume() { return state->outcome.get(); }
+
+   private:
+
+      struct State
+      {
+         explicit State(F job) : job(std::move(job)) {}
+
+         F job;
+         detail::Outcome<Result> outcome;
+      };
+
+      std::shared_ptr<State> state;
+      Executor executor;
+};
+
+/*! \public
+  \brief Returns an awaitable which runs `job` with the given executor and resumes the coroutine with the
+  result of the job on the request's event loop. Exceptions thrown by the job are rethrown in the coroutine.
+  The job's state is allocated on the heap, as it may outlive the coroutine frame (request finished meanwhile).
+  \param job The function to run
+  \param executor Runs the job on another thread (default: a new thread per job)
+  */
+
+template<typename F>
+Offload<F> offload(F job, Executor executor= threadExecutor)
+{
+   return Offload<F>(std::move(job), std::move(executor));
+}
+
+//***************************************************************************
+} // namespace cex
+
+#endif // CEX_WITH_COROUTINES
+#endif // __CORO_HPP__
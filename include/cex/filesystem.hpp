@@ -31,6 +31,13 @@ Example:
  The `defaultEncoding` is added to the `Content-Type` if it was set and the determined mimetype is not a binary type.
 
  If no mimetype could be found in the internal list, `Content-Type` falls back to `text/plain` with the `defaultEncoding`.
+
+ Files are sent with `Accept-Ranges: bytes`. `GET` requests with a `Range` header are answered with `206` and the
+ requested region (`Content-Range`), or a `multipart/byteranges` body for several ranges. Ranges are sent uncompressed,
+ directly from the file. An `If-Range` validator which does not match the file results in the whole file.
+
+ Responses carry the validators `ETag` and `Last-Modified` (see FilesystemOptions). Conditional `GET`/`HEAD` requests
+ (`If-None-Match`, `If-Modified-Since`) for unchanged files are answered with `304` without opening the file.
  
  */
 
@@ -56,13 +63,15 @@ namespace cex
 
 struct FilesystemOptions
 {
-   /*! \brief Constructs a new options object with defaultEncoding `utf-8` and empty rootPath*/
-   FilesystemOptions() : defaultEncoding("utf-8") {}
+   /*! \brief Constructs a new options object with defaultEncoding `utf-8`, empty rootPath and both validators enabled */
+   FilesystemOptions() : defaultEncoding("utf-8"), etag(true), lastModified(true) {}
 
    std::string rootPath;         /*!< \brief Specifies the root-path on the local filesystem
 
                                   The path of request URLs will be appended as relative paths when accessing files. */
    std::string defaultEncoding;  /*!< \brief The default encoding set in the `Content-Type` header */
+   bool etag;                    /*!< \brief Send an `ETag` (inode, size and modification time of the file) and honor `If-None-Match` and entity tags in `If-Range` (default: true) */
+   bool lastModified;            /*!< \brief Send `Last-Modified` and honor `If-Modified-Since` and dates in `If-Range` (default: true) */
 };
 
 /*! \public
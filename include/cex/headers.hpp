@@ -0,0 +1,70 @@
+//*************************************************************************
+// File headers.hpp
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// Well-known HTTP headers
+//*************************************************************************
+
+#ifndef __HEADERS_HPP__
+#define __HEADERS_HPP__
+
+/*! \file headers.hpp
+  \brief Well-known HTTP headers with O(1) lookup in requests */
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include <cstddef>
+
+namespace cex
+{
+namespace hdr
+{
+
+//***************************************************************************
+// definitions
+//***************************************************************************
+
+/*! \brief Well-known HTTP request headers. Each request indexes them in a single pass,
+  so `req->get(cex::hdr::Cookie)` does not scan the header list. */
+
+enum Header
+{
+   Accept,
+   AcceptEncoding,
+   AcceptLanguage,
+   Authorization,
+   CacheControl,
+   Connection,
+   ContentLength,
+   ContentType,
+   Cookie,
+   Expect,
+   Host,
+   IfModifiedSince,
+   IfNoneMatch,
+   IfRange,
+   Origin,
+   Range,
+   Referer,
+   TransferEncoding,
+   Upgrade,
+   UserAgent,
+   XForwardedFor,
+
+   count     /*!< Number of well-known headers, returned by find() for other names */
+};
+
+/*! \brief Returns the well-known header with the given name (case-insensitive), or `count` if the header is not well-known */
+Header find(const char* name, size_t len);
+
+/*! \brief Returns the name of a well-known header */
+const char* name(Header header);
+
+//***************************************************************************
+} // namespace hdr
+} // namespace cex
+
+#endif // __HEADERS_HPP__
@@ -1,7 +1,7 @@
 //*************************************************************************
 // File plist.hpp
 // Date 14.05.2018 - #1
-// Copyright (c) 2018-2018 by Patrick Fial
+// Copyright (c) 2018-2026 by Patrick Fial
 //-------------------------------------------------------------------------
 // Class PropertyList
 //*************************************************************************
@@ -10,7 +10,7 @@
 #define __PLIST_HPP__
 
 /*! \file plist.hpp
-  \brief Implementation of a simple propertylist based on `std::unordered_map`
+  \brief Implementation of a simple propertylist based on a flat, small-buffer array
 */
 
 
@@ -18,9 +18,12 @@
 // includes
 //***************************************************************************
 
-#include <unordered_map>
+#include <new>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include "stringview.hpp"
 
 namespace cex
 {
@@ -29,115 +32,313 @@ namespace cex
 // class Property
 //***************************************************************************
 /*! \class Property
-  \brief Describes a single property containing one or more typed values
+  \brief Describes a single property containing one typed value
 
-  A property can have several values, one for each of the types (string, long, double, void*)
+  A property holds either a string, a long, a double or a void* value. The getters
+  of the other types return their default value (empty string, 0, NULL).
   */
 
 typedef void (*prop_deleter)(void *);
+typedef bool (*prop_resolver)(void* owner, StringView key);
 
 class Property
 {
    public:
 
+      /*! \brief Type of the value held by a property */
+      enum Type
+      {
+         tpNone,
+         tpString,
+         tpLong,
+         tpDouble,
+         tpPointer
+      };
+
+      /*! \brief Constructs an empty property */
+      Property() : type(tpNone), longValue(0) {}
       /*! \brief Constructs a new property with a string value */
-      explicit Property(const std::string& value) : stringValue(value), longValue(0), doubleValue(0), ptrValue(nullptr), ptrDeleter(nullptr) {}
+      explicit Property(const std::string& value) : type(tpNone), longValue(0) { assign(value); }
       /*! \brief Constructs a new property with a string value (moving the value) */
-      explicit Property(std::string&& value)      : stringValue(std::move(value)), longValue(0), doubleValue(0), ptrValue(nullptr), ptrDeleter(nullptr) {}
+      explicit Property(std::string&& value)      : type(tpNone), longValue(0) { assign(std::move(value)); }
       /*! \brief Constructs a new property with a long value */
-      explicit Property(long value)               : longValue(value), doubleValue(0), ptrValue(nullptr), ptrDeleter(nullptr) {}
+      explicit Property(long value)               : type(tpLong), longValue(value) {}
       /*! \brief Constructs a new property with a double value */
-      explicit Property(double value)             : longValue(0), doubleValue(value), ptrValue(nullptr), ptrDeleter(nullptr) {}
+      explicit Property(double value)             : type(tpDouble), doubleValue(value) {}
       /*! \brief Constructs a new property with a void* value */
-      explicit Property(void* value, prop_deleter pd)   : longValue(0), doubleValue(0), ptrValue(value), ptrDeleter(pd) {}
+      explicit Property(void* value, prop_deleter pd)   : type(tpNone), longValue(0) { assign(value, pd); }
+
+      Property(Property&& other) : type(tpNone), longValue(0) { *this= std::move(other); }
+      Property(const Property&) = delete;
+      Property& operator=(const Property&) = delete;
+
+      /*! \brief Takes over the value of another property */
+      Property& operator=(Property&& other)
+      {
+         if (this == &other)
+            return *this;
+
+         switch (other.type)
+         {
+            case tpString:  assign(std::move(other.stringValue)); break;
+            case tpLong:    assign(other.longValue); break;
+            case tpDouble:  assign(other.doubleValue); break;
+            case tpPointer: assign(other.ptrValue.value, other.ptrValue.deleter); other.ptrValue.deleter= nullptr; break;
+            default:        clear(); break;
+         }
+
+         other.clear();
+         return *this;
+      }
+
       /*! \brief Destructs property with a deleter, if any */
-      ~Property() { if (ptrDeleter) ptrDeleter(ptrValue); }
+      ~Property() { clear(); }
+
+      /*! \brief Returns the type of the value */
+      Type getType() const                      { return type; }
 
       /*! \brief Retrieves the string value of the property. If no string value was set, returns an empty string object */
-      const std::string& getStringValue() const { return stringValue; }
+      const std::string& getStringValue() const { return type == tpString ? stringValue : emptyString(); }
       /*! \brief Retrieves the long value of the property. If no long value was set, returns 0 */
-      long getLongValue() const                 { return longValue; }
+      long getLongValue() const                 { return type == tpLong ? longValue : 0; }
       /*! \brief Retrieves the double value of the property. If no double value was set, returns 0 */
-      double getDoubleValue() const             { return doubleValue; }
+      double getDoubleValue() const             { return type == tpDouble ? doubleValue : 0; }
       /*! \brief Retrieves the void* value casted to the template type. If no void* was set, returns a null-pointer */
-      template<typename T> T* getObjectValue()  { return  (T*)ptrValue; }
+      template<typename T> T* getObjectValue() const { return type == tpPointer ? (T*)ptrValue.value : nullptr; }
+
+      /*! \brief Replaces the value with a string value */
+      void assign(const std::string& value)
+      {
+         if (type == tpString)
+         {
+            stringValue= value;
+            return;
+         }
+
+         clear();
+         new (&stringValue) std::string(value);
+         type= tpString;
+      }
+
+      /*! \brief Replaces the value with a string value (moving the value) */
+      void assign(std::string&& value)
+      {
+         if (type == tpString)
+         {
+            stringValue= std::move(value);
+            return;
+         }
+
+         clear();
+         new (&stringValue) std::string(std::move(value));
+         type= tpString;
+      }
+
+      /*! \brief Replaces the value with a long value */
+      void assign(long value)                   { clear(); longValue= value; type= tpLong; }
+      /*! \brief Replaces the value with a double value */
+      void assign(double value)                 { clear(); doubleValue= value; type= tpDouble; }
+      /*! \brief Replaces the value with a void* value. The deleter (if any) is called when the value is replaced or the property destructed */
+      void assign(void* value, prop_deleter pd) { clear(); ptrValue.value= value; ptrValue.deleter= pd; type= tpPointer; }
+
+      /*! \brief Removes the value (calling the deleter of void* values) */
+      void clear()
+      {
+         if (type == tpString)
+            stringValue.~basic_string();
+         else if (type == tpPointer && ptrValue.deleter)
+            ptrValue.deleter(ptrValue.value);
+
+         type= tpNone;
+         longValue= 0;
+      }
 
    private:
-      std::string stringValue;
-      long longValue;
-      double doubleValue;
-      void* ptrValue;
-      prop_deleter ptrDeleter;
+
+      static const std::string& emptyString() { static const std::string empty; return empty; }
+
+      struct Pointer
+      {
+         void* value;
+         prop_deleter deleter;
+      };
+
+      Type type;
+
+      union
+      {
+         std::string stringValue;
+         long longValue;
+         double doubleValue;
+         Pointer ptrValue;
+      };
 };
 
 //***************************************************************************
 // class PropertyList
 //***************************************************************************
 /*! \class PropertyList
-  \brief A simple list of properties implemented using `std::unordered_map`
+  \brief A simple list of properties implemented as a flat array
+
+  Each entry in the list is of type Property and can hold a value. The first `inlineCapacity`
+  entries are stored within the list itself, so typical lists do not allocate (except for
+  keys and string values which exceed the small string buffer). Keys are looked up with
+  a linear scan, without constructing temporary strings.
 
-  Each entry in the map is of type Property and can hold a value*/
+  An optional resolver is consulted when a key is not found. It may add the key
+  to the list on demand (see Request::properties).*/
 
 class PropertyList
 {
    public:
 
+      static const size_t inlineCapacity= 8;
+
+      PropertyList() : count(0), resolver(nullptr), resolverOwner(nullptr) {}
+
+      PropertyList(const PropertyList&) = delete;
+      PropertyList& operator=(const PropertyList&) = delete;
+
       /*! \brief Retrieves the Property object of a given key */
-      Property* getProperty(const std::string& key)
+      Property* getProperty(StringView key)
       {
-         auto res= entries.find(key);
-         return res != entries.end() ? res->second.get() : nullptr;
+         Entry* res= lookup(key);
+         return res ? &res->value : nullptr;
       }
 
       /*! \brief Retrieves the value of a given key as a class-pointer value (of type `T`) */
       template<typename T>
-      T* getObject(const std::string& key)
+      T* getObject(StringView key)
       {
-         auto res= entries.find(key);
-         return res != entries.end() ? res->second.get()->getObjectValue<T>() : nullptr;
+         Entry* res= lookup(key);
+         return res ? res->value.getObjectValue<T>() : nullptr;
       }
 
       /*! \brief Retrieves the long value of a given key */
-      long getLong(const std::string& key)
+      long getLong(StringView key)
       {
-         auto res= entries.find(key);
-         return res != entries.end() ? res->second.get()->getLongValue() : 0;
+         Entry* res= lookup(key);
+         return res ? res->value.getLongValue() : 0;
       }
 
       /*! \brief Retrieves the double value of a given key */
-      double getDouble(const std::string& key)
+      double getDouble(StringView key)
       {
-         auto res= entries.find(key);
-         return res != entries.end() ? res->second.get()->getDoubleValue() : 0;
+         Entry* res= lookup(key);
+         return res ? res->value.getDoubleValue() : 0;
       }
 
       /*! \brief Retrieves the string value of a given key */
-      std::string getString(const std::string& key)
+      std::string getString(StringView key)
       {
-         auto res= entries.find(key);
-         return res != entries.end() ? res->second.get()->getStringValue() : std::string();
+         Entry* res= lookup(key);
+         return res ? res->value.getStringValue() : std::string();
       }
 
       /*! \brief Sets the value of a key to a string value. Replaces previous values of a key */
-      void set(const std::string& key, const std::string& value)   { entries[key]= std::make_shared<Property>(value); }
+      void set(StringView key, const std::string& value)   { slot(key).assign(value); }
       /*! \brief Sets the value of a key to a string value (moving the content). Replaces previous values of a key */
-      void set(const std::string& key, std::string&& value) { entries[key]= std::make_shared<Property>(value); }
+      void set(StringView key, std::string&& value)        { slot(key).assign(std::move(value)); }
       /*! \brief Sets the value of a key to a long value. Replaces previous values of a key */
-      void set(const std::string& key, long value)          { entries[key]= std::make_shared<Property>(value); }
+      void set(StringView key, long value)                 { slot(key).assign(value); }
       /*! \brief Sets the value of a key to a double value. Replaces previous values of a key */
-      void set(const std::string& key, double value)        { entries[key]= std::make_shared<Property>(value); }
+      void set(StringView key, double value)               { slot(key).assign(value); }
       /*! \brief Sets the value of a key to a void* value. Replaces previous values of a key */
-      void set(const std::string& key, void* value, prop_deleter pd = nullptr)  { entries[key]= std::make_shared<Property>(value, pd); }
+      void set(StringView key, void* value, prop_deleter pd = nullptr)  { slot(key).assign(value, pd); }
 
       /*! \brief Checks if the list contains a given key */
-      bool has(const std::string& key)    { return entries.count(key) > 0; }
+      bool has(StringView key)    { return lookup(key) != nullptr; }
 
       /*! \brief Removes a key from the list and returns the number of elements removed (0 or 1) */
-      size_t remove(const std::string& key) { return entries.erase(key); }
+      size_t remove(StringView key)
+      {
+         Entry* res= lookup(key);
+
+         if (!res)
+            return 0;
+
+         // fill the gap with the last entry
+
+         Entry& last= at(count-1);
+
+         if (res != &last)
+         {
+            res->key.swap(last.key);
+            res->value= std::move(last.value);
+         }
+
+         last.value.clear();
+         last.key.clear();
+
+         if (count > inlineCapacity)
+            overflow.pop_back();
+
+         count--;
+
+         return 1;
+      }
+
+      /*! \brief Returns the number of properties in the list */
+      size_t size() const { return count; }
+
+      /*! \brief Sets a callback which is invoked for keys which are not in the list. If the
+        resolver returns `true`, the lookup is repeated */
+      void setResolver(prop_resolver r, void* owner) { resolver= r; resolverOwner= owner; }
 
    private:
 
-      std::map<std::string, std::shared_ptr<Property>> entries;
+      struct Entry
+      {
+         std::string key;
+         Property value;
+      };
+
+      Entry& at(size_t i) { return i < inlineCapacity ? local[i] : overflow[i - inlineCapacity]; }
+
+      Entry* find(StringView key)
+      {
+         for (size_t i= 0; i < count; i++)
+         {
+            Entry& e= at(i);
+
+            if (e.key.size() == key.size() && StringView(e.key) == key)
+               return &e;
+         }
+
+         return nullptr;
+      }
+
+      Entry* lookup(StringView key)
+      {
+         Entry* res= find(key);
+
+         if (res || !resolver)
+            return res;
+
+         return resolver(resolverOwner, key) ? find(key) : nullptr;
+      }
+
+      Property& slot(StringView key)
+      {
+         Entry* res= find(key);
+
+         if (res)
+            return res->value;
+
+         if (count >= inlineCapacity)
+            overflow.emplace_back();
+
+         Entry& e= at(count++);
+         e.key.assign(key.data() ? key.data() : "", key.size());
+
+         return e.value;
+      }
+
+      Entry local[inlineCapacity];
+      size_t count;
+      std::vector<Entry> overflow;
+      prop_resolver resolver;
+      void* resolverOwner;
 };
 
 //***************************************************************************
@@ -0,0 +1,134 @@
+//*************************************************************************
+// File regexset.hpp
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// Class RegexSet
+// Multiple regular expressions matched in a single pass
+//*************************************************************************
+
+#ifndef __REGEXSET_HPP__
+#define __REGEXSET_HPP__
+
+/*! \file regexset.hpp
+  \brief Set of regular expressions compiled into a single automaton */
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include <bitset>
+#include <string>
+#include <vector>
+
+namespace cex
+{
+
+//***************************************************************************
+// class RegexSet
+//***************************************************************************
+/*! \class RegexSet
+  \brief Matches a string against many regular expressions at once.
+
+  All expressions are combined into one Thompson NFA which is converted into a DFA
+  when the set is compiled. Matching then takes one pass over the input without
+  backtracking and returns the ids of all expressions which would match with
+  `std::regex_search`.
+
+  Only a subset of the ECMAScript syntax can be compiled: literals, `.`, character
+  classes, the `\\d \\w \\s` escapes (and their negations), groups, alternation,
+  the quantifiers `* + ? {n,m}` and the anchors `^` and `$`. add() rejects everything
+  else (back references, look-aheads, word boundaries, ...), such expressions have to
+  be evaluated with `std::regex`.
+
+  If the DFA would exceed `maxStates` states, the NFA is simulated instead, which is
+  still linear in the length of the input.
+  */
+
+class RegexSet
+{
+   public:
+
+      RegexSet();
+
+      /*! \brief Adds a regular expression
+        \param pattern The expression (ECMAScript syntax)
+        \param id The id reported by match() if the expression matches
+        \return `true` if the expression was added, `false` if it uses unsupported syntax */
+      bool add(const std::string& pattern, size_t id);
+
+      /*! \brief Builds the automaton. Must be called after adding expressions and before match() */
+      void compile();
+
+      /*! \brief Appends the ids of all expressions found in `text` to `ids` (in no particular order) */
+      void match(const char* text, std::vector<size_t>& ids) const;
+
+      /*! \brief Removes all expressions */
+      void clear();
+
+      bool empty() const { return starts.empty(); }
+      bool isCompiled() const { return compiled; }
+
+      static const size_t maxStates= 4096;
+
+   private:
+
+      typedef std::bitset<256> CharSet;
+
+      enum StateType
+      {
+         stChar,
+         stSplit,
+         stEpsilon,
+         stBegin,
+         stEnd,
+         stMatch
+      };
+
+      struct State
+      {
+         StateType type;
+         int out;
+         int out1;
+         size_t id;        // stChar: index into charSets, stMatch: expression id
+      };
+
+      struct Ast;
+      struct Parser;
+      struct Fragment;
+
+      struct DfaState
+      {
+         std::vector<int> states;          // NFA states (stChar, stMatch, stEnd)
+         std::vector<size_t> matches;      // ids matching at this position
+         std::vector<size_t> endMatches;   // ids matching if the input ends here
+      };
+
+      int newState(StateType type, int out= -1, int out1= -1, size_t id= 0);
+      Fragment build(const Ast& ast);
+      void closure(std::vector<int>& set, bool atStart, bool atEnd, std::vector<unsigned>& marks, unsigned mark) const;
+      void step(const std::vector<int>& from, int byteClass, std::vector<int>& to, std::vector<unsigned>& marks, unsigned& mark) const;
+      void collect(const std::vector<int>& set, std::vector<size_t>& ids, bool endOnly) const;
+      void simulate(const char* text, std::vector<size_t>& ids) const;
+
+      std::vector<State> nfa;
+      std::vector<CharSet> charSets;
+      std::vector<int> starts;
+
+      // compiled automaton
+
+      bool compiled;
+      bool useDfa;
+      int classCount;
+      unsigned char byteClass[256];
+      std::vector<unsigned char> classByte;    // representative byte of each class
+      std::vector<int> reinject;               // closure of all starts (not at begin of input)
+      std::vector<DfaState> dfa;
+      std::vector<int> transitions;            // dfa.size() x classCount
+      std::vector<size_t> emptyMatches;        // ids matching the empty input
+};
+
+//***************************************************************************
+} // namespace cex
+
+#endif // __REGEXSET_HPP__
@@ -0,0 +1,207 @@
+//*************************************************************************
+// File router.hpp
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// Class Router
+// Radix tree based lookup of the middlewares matching a request
+//*************************************************************************
+
+#ifndef __ROUTER_HPP__
+#define __ROUTER_HPP__
+
+/*! \file router.hpp
+  \brief Radix tree based middleware lookup used by the Server */
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "stringview.hpp"
+#include "regexset.hpp"
+
+namespace cex
+{
+
+class Request;
+class Middleware;
+
+/*! \brief List of captured path parameters (name, value), values are views into the request URL */
+typedef std::vector<std::pair<StringView, StringView>> RouteParams;
+
+//***************************************************************************
+// class PathPattern
+//***************************************************************************
+/*! \class PathPattern
+  \brief Segment matcher for `fMatchPattern` middleware paths.
+
+  A pattern consists of literal text, named parameters and an optional trailing wildcard:
+
+  \li `:name` matches one non-empty path segment (up to the next `/`)
+  \li `*name` matches the remainder of the path, including slashes (may be empty). Only allowed at the end.
+
+  The pattern must match the whole path. For example, the pattern `/users/:id/orders/` followed by
+  `*rest` matches `/users/123/orders/a/b` with `id` = `123` and `rest` = `a/b`. The pattern is compiled
+  once, matching does not allocate except for storing the captured values.
+  */
+
+class PathPattern
+{
+   public:
+
+      PathPattern() {}
+      explicit PathPattern(const std::string& pattern);
+
+      /*! \brief Matches the path against the pattern
+        \param path The (full) path of the request
+        \param params If not NULL, receives the captured parameters (cleared first)
+        \return `true` if the path matches */
+      bool match(const char* path, RouteParams* params) const;
+
+      /*! \brief Returns the literal text preceding the first parameter/wildcard */
+      const std::string& prefix() const { return literalPrefix; }
+
+   private:
+
+      enum SegmentType
+      {
+         sgLiteral,
+         sgParam,
+         sgWildcard
+      };
+
+      struct Segment
+      {
+         SegmentType type;
+         std::string text;    // literal text or parameter name
+      };
+
+      std::vector<Segment> segments;
+      std::string literalPrefix;
+};
+
+//***************************************************************************
+// class Router
+//***************************************************************************
+/*! \class Router
+  \brief Resolves the ordered chain of middlewares matching a request.
+
+  Middlewares are partitioned by HTTP method when they are added: each method has
+  its own lookup table, method-agnostic middlewares (`use()`) are stored in a
+  separate table. A request only searches the table of its method and the
+  method-agnostic one, the results are merged by registration index.
+
+  Within a table, middleware paths are stored in a compressed radix tree. `fMatchCompare`
+  paths are found with a single descent, `fMatchContain` paths by descending from each
+  URL offset which can start a registered path (for paths starting with `/` these
+  are just the slashes of the URL). `fMatchPattern` paths are indexed by their
+  literal prefix and verified with their PathPattern. Global middlewares (no path)
+  are always candidates.
+
+  `fMatchRegex` paths are combined into one RegexSet, so all of them are matched in
+  a single pass over the URL. The set is compiled on the first lookup after a
+  middleware was added. Expressions the RegexSet cannot compile are evaluated
+  one by one with Middleware::match.
+
+  The resulting chain preserves the registration order of the middlewares.
+
+  Optionally (setCacheSize()), each thread keeps a bounded LRU cache which maps
+  method and path of a request to its resolved chain. The cache is invalidated
+  whenever middlewares are added or removed.
+  */
+
+class Router
+{
+   public:
+
+      /*! \brief Hit/miss counters of the route cache (summed over all threads) */
+      struct CacheStats
+      {
+         unsigned long long hits;
+         unsigned long long misses;
+      };
+
+      Router();
+
+      /*! \brief Adds a middleware. Its registration index is the number of middlewares added before. */
+      void add(Middleware* mw);
+
+      /*! \brief Removes all middlewares */
+      void clear();
+
+      /*! \brief Returns the number of middlewares added */
+      size_t size() const { return entries.size(); }
+
+      /*! \brief Collects all middlewares which match the request (path AND method) in registration order
+        \param req The request to match
+        \param chain Receives the matching middlewares (cleared first) */
+      void resolve(Request* req, std::vector<Middleware*>& chain) const;
+
+      /*! \brief Sets the maximum number of entries of the per-thread route cache (0 disables the cache) */
+      void setCacheSize(size_t size) { cacheSize= size; }
+
+      /*! \brief Returns the maximum number of entries of the per-thread route cache */
+      size_t getCacheSize() const { return cacheSize; }
+
+      /*! \brief Returns the hit/miss counters of the route cache */
+      CacheStats getCacheStats() const;
+
+   private:
+
+      struct Node
+      {
+         std::string label;
+         std::vector<std::unique_ptr<Node>> children;
+         std::vector<size_t> exact;
+         std::vector<size_t> contain;
+         std::vector<size_t> pattern;
+
+         Node* child(char c) const;
+      };
+
+      struct Table
+      {
+         Table();
+
+         void add(Middleware* mw, size_t index);
+         void collect(Request* req, const std::vector<Middleware*>& entries, std::vector<size_t>& candidates) const;
+
+         Node* insert(const std::string& key);
+         void collectExact(const char* url, std::vector<size_t>& candidates) const;
+         void collectContain(const char* url, std::vector<size_t>& candidates) const;
+         void collectPattern(const char* url, const std::vector<Middleware*>& entries, std::vector<size_t>& candidates) const;
+         void collectRegex(const char* url, std::vector<size_t>& candidates) const;
+
+         Node root;
+         std::vector<size_t> always;      // global middlewares, path is irrelevant
+         std::vector<size_t> evaluate;    // unsupported regex syntax, evaluated with Middleware::match
+         bool startsKey[256];             // first bytes of all contain-keys
+
+         mutable RegexSet regexes;        // fMatchRegex paths, id = registration index
+         mutable std::mutex regexMutex;
+         mutable std::atomic<bool> regexesCompiled;
+      };
+
+      void lookup(Request* req, std::vector<size_t>& candidates) const;
+
+      std::vector<Middleware*> entries;
+      Table any;                                      // method-agnostic middlewares
+      std::vector<std::unique_ptr<Table>> methods;    // indexed by evhtp method
+
+      size_t cacheSize;
+      unsigned long long instance;                    // identifies the owner of a thread's route cache
+      std::atomic<unsigned long long> generation;     // changes whenever middlewares are added/removed
+      mutable std::atomic<unsigned long long> cacheHits;
+      mutable std::atomic<unsigned long long> cacheMisses;
+};
+
+//***************************************************************************
+} // namespace cex
+
+#endif // __ROUTER_HPP__
@@ -164,6 +164,9 @@ struct SecurityOptions
 
 /*! \public
   \brief Creates a middleware that sets a number of HTTP headers related to security
+
+  The headers are built from the options once, when the middleware is created, and attached to each response
+  as HeaderBlock. Changing the options afterwards has no effect.
  */
 MiddlewareFunction securityHeaders(const std::shared_ptr<SecurityOptions>& opts= nullptr);
 
@@ -93,11 +93,24 @@ struct SessionOptions
    bool sameSiteLax;
 };
 
+/*! \struct SessionInfo
+  \brief The session of the current request as set by the sessionHandler middleware (request slot) */
+
+struct SessionInfo
+{
+   /*! \brief Name of the session cookie */
+   std::string name;
+
+   /*! \brief The session ID */
+   std::string id;
+};
+
 /*! \public 
   \brief Creates a middleware function which gets/creates session IDs 
  
   Extracts the cookie with the configured name from the request. If no cookie could be found, a new session ID is created and a 
-  cookie is attached to the Response object. The session ID is also added to the Request object's property list. The name of the 
+  cookie is attached to the Response object. The session ID is stored in the Request object's SessionInfo slot
+  (`req->slot<cex::SessionInfo>()`), and is also available in the property list. The name of the
   property corresponds to the cookie/session ID name.
  */
 MiddlewareFunction sessionHandler(const std::shared_ptr<SessionOptions>& opts = nullptr);
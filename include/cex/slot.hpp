@@ -0,0 +1,91 @@
+//*************************************************************************
+// File slot.hpp
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// Class Slot
+// Typed request-local storage
+//*************************************************************************
+
+#ifndef __SLOT_HPP__
+#define __SLOT_HPP__
+
+/*! \file slot.hpp
+  \brief Typed request-local storage slots */
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include <cstddef>
+
+namespace cex
+{
+
+//***************************************************************************
+// class SlotRegistry
+//***************************************************************************
+/*! \class SlotRegistry
+  \brief Hands out the indices of all Slot types */
+
+class SlotRegistry
+{
+   public:
+
+      /*! \brief Reserves the next free slot index */
+      static size_t reserve();
+
+      /*! \brief Returns the number of slot indices reserved so far */
+      static size_t count();
+};
+
+//***************************************************************************
+// class Slot
+//***************************************************************************
+/*! \class Slot
+  \brief Reserves a typed storage slot in every request.
+
+  Each type `T` used with Request::slot() gets a fixed index during static
+  initialization, so accessing the value of a request is a plain array access,
+  without any string keys. Values are constructed in the request's Arena and
+  destructed with the request.
+
+  Example:
+```
+   struct UserInfo { long id; std::string name; };
+
+   app.use([](cex::Request* req, cex::Response* res, std::function<void()> next)
+   {
+      req->emplaceSlot<UserInfo>(UserInfo{ 42, "john" });
+      next();
+   });
+
+   app.get([](cex::Request* req, cex::Response* res, std::function<void()> next)
+   {
+      UserInfo* user= req->slot<UserInfo>();   // NULL if not set
+      ...
+   });
+```
+  Distinct slots of the same value type can be declared using a different `Tag` type.
+  */
+
+template<typename T, typename Tag= T>
+class Slot
+{
+   public:
+
+      /*! \brief Returns the index of the slot */
+      static size_t index() { return id; }
+
+   private:
+
+      static const size_t id;
+};
+
+template<typename T, typename Tag>
+const size_t Slot<T, Tag>::id= SlotRegistry::reserve();
+
+//***************************************************************************
+} // namespace cex
+
+#endif // __SLOT_HPP__
@@ -0,0 +1,83 @@
+//*************************************************************************
+// File stringview.hpp
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// Class StringView
+//*************************************************************************
+
+#ifndef __STRINGVIEW_HPP__
+#define __STRINGVIEW_HPP__
+
+/*! \file stringview.hpp
+  \brief Non-owning view of a character sequence (C++11 replacement for `std::string_view`) */
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include <cstring>
+#include <string>
+
+#if __cplusplus >= 201703L
+#  include <string_view>
+#endif
+
+namespace cex
+{
+
+//***************************************************************************
+// class StringView
+//***************************************************************************
+/*! \class StringView
+  \brief A pointer/length pair referencing characters owned by someone else.
+
+  The referenced characters are **not** necessarily NUL-terminated. A view is only valid
+  as long as the underlying storage (e.g. the request) is alive. When compiled with C++17
+  or newer, a StringView converts implicitly from and to `std::string_view`.
+  */
+
+class StringView
+{
+   public:
+
+      /*! \brief Constructs an empty view */
+      StringView() : ptr(nullptr), len(0) {}
+      /*! \brief Constructs a view of a NUL-terminated string */
+      StringView(const char* s) : ptr(s), len(s ? strlen(s) : 0) {}
+      /*! \brief Constructs a view of `n` characters starting at `s` */
+      StringView(const char* s, size_t n) : ptr(s), len(n) {}
+      /*! \brief Constructs a view of the contents of a `std::string` */
+      StringView(const std::string& s) : ptr(s.data()), len(s.size()) {}
+#if __cplusplus >= 201703L
+      /*! \brief Constructs a view of the contents of a `std::string_view` */
+      StringView(std::string_view s) : ptr(s.data()), len(s.size()) {}
+#endif
+
+      const char* data() const { return ptr; }       /*!< \brief Returns the first character (may be NULL for empty views) */
+      size_t size() const { return len; }            /*!< \brief Returns the number of characters */
+      size_t length() const { return len; }          /*!< \brief Returns the number of characters */
+      bool empty() const { return !len; }            /*!< \brief Returns `true` if the view has no characters */
+      const char* begin() const { return ptr; }
+      const char* end() const { return ptr + len; }
+      char operator[](size_t i) const { return ptr[i]; }
+
+      /*! \brief Returns a copy of the viewed characters */
+      std::string str() const { return ptr ? std::string(ptr, len) : std::string(); }
+
+      bool operator==(const StringView& other) const { return len == other.len && (!len || !memcmp(ptr, other.ptr, len)); }
+      bool operator!=(const StringView& other) const { return !(*this == other); }
+
+#if __cplusplus >= 201703L
+      operator std::string_view() const { return std::string_view(ptr, len); }
+#endif
+
+   private:
+      const char* ptr;
+      size_t len;
+};
+
+//***************************************************************************
+} // namespace cex
+
+#endif // __STRINGVIEW_HPP__
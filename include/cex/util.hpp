@@ -22,6 +22,7 @@
 #include <cstring>
 
 struct evbuffer;
+struct z_stream_s;
 
 namespace cex
 {
@@ -48,6 +49,42 @@ std::string randomStringHex(int len);
 #ifdef CEX_WITH_ZLIB
 int compress(const char* src, size_t srcLen, struct evbuffer* dest, CompressionMode compMode= cmGZip);
 int compress(std::istream* stream, std::function<void(char*,size_t)> onChunk, CompressionMode compMode);
+
+//***************************************************************************
+// class StreamCompressor
+//***************************************************************************
+/*! \class StreamCompressor
+  \brief Incremental GZIP/deflate compression of data which arrives piecewise.
+
+  Each call of write() compresses the given input and appends whatever output zlib
+  produced to the destination buffer. finish() flushes the remaining output.
+  */
+
+class StreamCompressor
+{
+   public:
+
+      explicit StreamCompressor(CompressionMode compMode= cmGZip);
+      ~StreamCompressor();
+
+      StreamCompressor(const StreamCompressor&) = delete;
+      StreamCompressor& operator=(const StreamCompressor&) = delete;
+
+      /*! \brief Returns `true` if the compressor could be initialized and no error occured so far */
+      bool good() const { return strm != nullptr; }
+
+      /*! \brief Compresses `srcLen` bytes and appends the output (if any) to `dest` */
+      int write(const char* src, size_t srcLen, struct evbuffer* dest);
+
+      /*! \brief Finishes the compressed stream and appends the remaining output to `dest` */
+      int finish(struct evbuffer* dest);
+
+   private:
+
+      int deflateTo(struct evbuffer* dest, int flush);
+
+      struct z_stream_s* strm;
+};
 #endif
 
 static inline void lTrim(std::string &s) 
@@ -0,0 +1,209 @@
+//*************************************************************************
+// File arena.cc
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// cex Library Arena class implementation
+//*************************************************************************
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include <cex/arena.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+
+namespace cex
+{
+
+//***************************************************************************
+// definitions
+//***************************************************************************
+
+static const size_t maxFreeArenas= 64;
+static const size_t largeSize= Arena::blockSize / 4;
+static const size_t headerSize= (sizeof(void*) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+struct ArenaList
+{
+   ~ArenaList()
+   {
+      for (auto a : arenas)
+         delete a;
+   }
+
+   std::vector<Arena*> arenas;
+};
+
+static thread_local ArenaList freeArenas;
+
+//***************************************************************************
+// class Arena
+//***************************************************************************
+// ctor/dtor
+//***************************************************************************
+
+Arena::Arena()
+{
+   first= current= (Block*)malloc(blockSize);
+
+   if (!first)
+      throw std::bad_alloc();
+
+   first->next= nullptr;
+   pos= (char*)first + headerSize;
+   end= (char*)first + blockSize;
+}
+
+Arena::~Arena()
+{
+   reset();
+   free(first);
+}
+
+//***************************************************************************
+// allocate
+//***************************************************************************
+
+void* Arena::allocate(size_t size, size_t align)
+{
+   if (size > largeSize)
+   {
+      void* p= malloc(size);
+
+      if (!p)
+         throw std::bad_alloc();
+
+      large.push_back(p);
+      return p;
+   }
+
+   char* p= (char*)(((uintptr_t)pos + align - 1) & ~(uintptr_t)(align - 1));
+
+   if (p + size > end)
+   {
+      // start a new block
+
+      Block* block= (Block*)malloc(blockSize);
+
+      if (!block)
+         throw std::bad_alloc();
+
+      block->next= nullptr;
+      current->next= block;
+      current= block;
+
+      pos= (char*)block + headerSize;
+      end= (char*)block + blockSize;
+      p= (char*)(((uintptr_t)pos + align - 1) & ~(uintptr_t)(align - 1));
+   }
+
+   pos= p + size;
+
+   return p;
+}
+
+//***************************************************************************
+// deallocate
+//***************************************************************************
+
+void Arena::deallocate(void* p, size_t size)
+{
+   if (!p)
+      return;
+
+   if (size > largeSize)
+   {
+      // most likely the latest large allocation (growing buffer)
+
+      auto it= std::find(large.rbegin(), large.rend(), p);
+
+      if (it != large.rend())
+      {
+         free(p);
+         large.erase(std::next(it).base());
+      }
+
+      return;
+   }
+
+   if ((char*)p + size == pos)
+      pos= (char*)p;
+}
+
+//***************************************************************************
+// strdup
+//***************************************************************************
+
+char* Arena::strdup(const char* s, size_t len)
+{
+   char* res= (char*)allocate(len + 1, 1);
+
+   memcpy(res, s, len);
+   res[len]= 0;
+
+   return res;
+}
+
+//***************************************************************************
+// reset
+//***************************************************************************
+
+void Arena::reset()
+{
+   for (auto p : large)
+      free(p);
+
+   large.clear();
+
+   Block* block= first->next;
+
+   while (block)
+   {
+      Block* next= block->next;
+      free(block);
+      block= next;
+   }
+
+   first->next= nullptr;
+   current= first;
+   pos= (char*)first + headerSize;
+   end= (char*)first + blockSize;
+}
+
+//***************************************************************************
+// acquire/release
+//***************************************************************************
+
+Arena* Arena::acquire()
+{
+   if (freeArenas.arenas.empty())
+      return new Arena();
+
+   Arena* arena= freeArenas.arenas.back();
+   freeArenas.arenas.pop_back();
+
+   return arena;
+}
+
+void Arena::release(Arena* arena)
+{
+   if (!arena)
+      return;
+
+   if (freeArenas.arenas.size() >= maxFreeArenas)
+   {
+      delete arena;
+      return;
+   }
+
+   arena->reset();
+   freeArenas.arenas.push_back(arena);
+}
+
+//***************************************************************************
+} // namespace cex
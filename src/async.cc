@@ -0,0 +1,184 @@
+//*************************************************************************
+// File async.cc
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// cex Library asynchronous completion of requests
+//*************************************************************************
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include <cex/core.hpp>
+
+namespace cex
+{
+
+//***************************************************************************
+// class AsyncHandle
+//***************************************************************************
+
+struct AsyncHandle::Call
+{
+   AsyncHandlePtr handle;
+   MiddlewareFunction func;
+};
+
+AsyncHandle::AsyncHandle(Server::Context* ctx, evhtp_request* req)
+   : ctx(ctx), req(req), base(nullptr), alive(true), paused(false), timer(nullptr), timerFunc(nullptr), timerArg(nullptr)
+{
+   evhtp_connection_t* conn= evhtp_request_get_connection(req);
+
+   if (conn)
+      base= conn->evbase;
+}
+
+AsyncHandle::~AsyncHandle()
+{
+   stopTimer();
+}
+
+//***************************************************************************
+// post (marshal a function to the event loop of the request)
+//***************************************************************************
+
+bool AsyncHandle::post(MiddlewareFunction func)
+{
+   return schedule(std::move(func), nullptr);
+}
+
+bool AsyncHandle::postDelayed(MiddlewareFunction func, std::chrono::milliseconds delay)
+{
+   struct timeval tv;
+
+   tv.tv_sec= delay.count() / 1000;
+   tv.tv_usec= (delay.count() % 1000) * 1000;
+
+   return schedule(std::move(func), &tv);
+}
+
+bool AsyncHandle::schedule(MiddlewareFunction func, const struct timeval* delay)
+{
+   if (!alive || !base || !func)
+      return false;
+
+   // event_base_once is thread-safe (evthread_use_pthreads) and wakes up the event loop
+
+   Call* call= new Call{ shared_from_this(), std::move(func) };
+
+   if (event_base_once(base, -1, EV_TIMEOUT, &AsyncHandle::handleCall, call, delay))
+   {
+      delete call;
+      return false;
+   }
+
+   return true;
+}
+
+bool AsyncHandle::end(int status)
+{
+   return post([status](Request* req, Response* res, const std::function<void()>& next)
+   {
+      res->end(status);
+   });
+}
+
+bool AsyncHandle::end(std::string&& string, int status)
+{
+   auto body= std::make_shared<std::string>(std::move(string));
+
+   return post([body, status](Request* req, Response* res, const std::function<void()>& next)
+   {
+      res->end(std::move(*body), status);
+   });
+}
+
+bool AsyncHandle::next()
+{
+   return post([](Request* req, Response* res, const std::function<void()>& next)
+   {
+      next();
+   });
+}
+
+//***************************************************************************
+// callLater (timer on the owning event loop, no allocation per call)
+//***************************************************************************
+
+bool AsyncHandle::callLater(std::chrono::milliseconds delay, void (*func)(Request* req, void* arg), void* arg)
+{
+   if (!alive || !base || !func)
+      return false;
+
+   if (!timer)
+      timer= evtimer_new(base, &AsyncHandle::handleTimer, this);
+
+   if (!timer || evtimer_pending(timer, nullptr))
+      return false;
+
+   struct timeval tv;
+
+   tv.tv_sec= delay.count() / 1000;
+   tv.tv_usec= (delay.count() % 1000) * 1000;
+
+   timerFunc= func;
+   timerArg= arg;
+
+   return !evtimer_add(timer, &tv);
+}
+
+void AsyncHandle::stopTimer()
+{
+   if (timer)
+      event_free(timer);
+
+   timer= nullptr;
+}
+
+//***************************************************************************
+// handleCall/handleTimer (on the event loop owning the request)
+//***************************************************************************
+
+void AsyncHandle::handleCall(evutil_socket_t fd, short what, void* arg)
+{
+   std::unique_ptr<Call> call(reinterpret_cast<Call*>(arg));
+   AsyncHandle* handle= call->handle.get();
+
+   if (!handle->alive)
+      return;
+
+   Server::Context* ctx= handle->ctx;
+
+   call->func(ctx->req.get(), ctx->res.get(), ctx->dispatcher.next);
+
+   handle->finishCall();
+}
+
+void AsyncHandle::handleTimer(evutil_socket_t fd, short what, void* arg)
+{
+   // the timer is freed with the request (or the handle), so the handle is still valid here
+
+   AsyncHandle* handle= reinterpret_cast<AsyncHandle*>(arg);
+
+   if (!handle->alive)
+      return;
+
+   handle->timerFunc(handle->ctx->req.get(), handle->timerArg);
+   handle->finishCall();
+}
+
+void AsyncHandle::finishCall()
+{
+   // the request is paused, so sending the reply did not finish it yet. resuming
+   // must happen after the reply was sent (and may finish the request)
+
+   if (alive && paused && ctx->res.get()->isDone())
+   {
+      paused= false;
+      evhtp_request_resume(req);
+   }
+}
+
+//***************************************************************************
+} // namespace cex
@@ -27,6 +27,30 @@ static const int B64index[256] =
    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51 
 };
 
+//***************************************************************************
+// legacy properties (basicUsername, basicPassword)
+//***************************************************************************
+
+static bool basicAuthProperties(Request* req, StringView key)
+{
+   if (key != "basicUsername" && key != "basicPassword")
+      return false;
+
+   BasicCredentials* credentials= req->slot<BasicCredentials>();
+
+   if (!credentials)
+      return false;
+
+   req->properties.set("basicUsername", credentials->username);
+
+   if (!credentials->password.empty())
+      req->properties.set("basicPassword", credentials->password);
+
+   return true;
+}
+
+static const bool basicAuthPropertiesRegistered= Request::registerPropertyShim(&basicAuthProperties);
+
 //***************************************************************************
 // Middleware basicAuth
 //***************************************************************************
@@ -35,7 +59,7 @@ MiddlewareFunction basicAuth()
 {
    MiddlewareFunction res = [](Request* req, Response* res, const std::function<void()>& next)
    {
-      const char* authenticationHeader= req->get("Authorization");
+      const char* authenticationHeader= req->get(hdr::Authorization);
 
       if (!authenticationHeader || strncmp(authenticationHeader, "Basic", 5) != 0 || strlen(authenticationHeader) < 7)
       {
@@ -71,7 +95,7 @@ MiddlewareFunction basicAuth()
          }
       }
 
-      // split the decoded value by ':' and save it in request plist
+      // split the decoded value by ':' and save it in the request's slot
 
       if (str.length())
       {
@@ -79,10 +103,12 @@ MiddlewareFunction basicAuth()
 
          if (!splitted.empty())
          {
-            req->properties.set("basicUsername", splitted[0]);
+            BasicCredentials& credentials= req->emplaceSlot<BasicCredentials>();
+
+            credentials.username= std::move(splitted[0]);
 
             if (splitted.size() > 1)
-               req->properties.set("basicPassword", splitted[1]);
+               credentials.password= std::move(splitted[1]);
          }
       }
 
@@ -12,13 +12,263 @@
 //***************************************************************************
 
 #include <cex/filesystem.hpp>
+#include <cex/util.hpp>
 
-#include <fstream>
+#include <cerrno>
+#include <istream>
 #include <cctype>
+#include <ctime>
+#include <vector>
+
+#include <fcntl.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace cex
 {
 
+//***************************************************************************
+// class FileStream (input stream reading from an open file descriptor)
+//***************************************************************************
+
+class FileBuffer : public std::streambuf
+{
+   public:
+
+      explicit FileBuffer(int fd) : fd(fd) {}
+      ~FileBuffer() { close(fd); }
+
+   protected:
+
+      int_type underflow() override
+      {
+         ssize_t bytesRead;
+
+         do
+            bytesRead= read(fd, buffer, sizeof(buffer));
+         while (bytesRead < 0 && errno == EINTR);
+
+         if (bytesRead <= 0)
+            return traits_type::eof();
+
+         setg(buffer, buffer, buffer + bytesRead);
+
+         return traits_type::to_int_type(*gptr());
+      }
+
+   private:
+
+      int fd;
+      char buffer[IO_BUFFER_SIZE];
+};
+
+// the buffer is a base class, so it is constructed before the stream using it
+
+class FileStream : private FileBuffer, public std::istream
+{
+   public:
+
+      explicit FileStream(int fd) : FileBuffer(fd), std::istream(this) {}
+};
+
+//***************************************************************************
+// byte ranges (Range header)
+//***************************************************************************
+
+struct ByteRange
+{
+   unsigned long long first;
+   unsigned long long last;     // inclusive
+};
+
+enum RangeResult
+{
+   rangeIgnore,                 // no or invalid Range header, send the whole file
+   rangeSatisfiable,
+   rangeUnsatisfiable
+};
+
+static const size_t maxRanges= 16;
+
+static RangeResult parseRanges(const char* header, unsigned long long size, std::vector<ByteRange>& ranges)
+{
+   // bytes=0-99,200-,-500 (RFC 7233). invalid headers (and too many ranges) are ignored, as permitted by the RFC
+
+   if (strncasecmp(header, "bytes=", 6))
+      return rangeIgnore;
+
+   const char* p= header + 6;
+   size_t specs= 0;
+
+   while (*p)
+   {
+      while (*p == ' ' || *p == '\t' || *p == ',')
+         p++;
+
+      if (!*p)
+         break;
+
+      if (++specs > maxRanges)
+         return rangeIgnore;
+
+      ByteRange range;
+      char* end;
+
+      if (*p == '-')
+      {
+         // suffix range (last n bytes)
+
+         if (!isdigit(*++p))
+            return rangeIgnore;
+
+         unsigned long long n= strtoull(p, &end, 10);
+         p= end;
+
+         range.first= n >= size ? 0 : size - n;
+         range.last= size - 1;
+
+         if (!n || !size)
+            range.first= size;      // unsatisfiable
+      }
+      else if (isdigit(*p))
+      {
+         range.first= strtoull(p, &end, 10);
+         p= end;
+
+         if (*p++ != '-')
+            return rangeIgnore;
+
+         range.last= size - 1;
+
+         if (isdigit(*p))
+         {
+            unsigned long long last= strtoull(p, &end, 10);
+            p= end;
+
+            if (last < range.first)
+               return rangeIgnore;
+
+            if (last < range.last)
+               range.last= last;
+         }
+      }
+      else
+         return rangeIgnore;
+
+      while (*p == ' ' || *p == '\t')
+         p++;
+
+      if (*p && *p != ',')
+         return rangeIgnore;
+
+      if (range.first < size)
+         ranges.push_back(range);
+   }
+
+   if (!specs)
+      return rangeIgnore;
+
+   return ranges.empty() ? rangeUnsatisfiable : rangeSatisfiable;
+}
+
+static std::string contentRange(const ByteRange& range, unsigned long long size)
+{
+   char buf[100];
+   snprintf(buf, sizeof(buf), "bytes %llu-%llu/%llu", range.first, range.last, size);
+
+   return buf;
+}
+
+//***************************************************************************
+// httpDate (IMF-fixdate)
+//***************************************************************************
+
+static std::string httpDate(time_t t)
+{
+   static const char* days[]= { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+   static const char* months[]= { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+   struct tm tm;
+   char buf[64];
+
+   gmtime_r(&t, &tm);
+   snprintf(buf, sizeof(buf), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+         days[tm.tm_wday], tm.tm_mday, months[tm.tm_mon], tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec);
+
+   return buf;
+}
+
+static bool parseHttpDate(const char* value, time_t& result)
+{
+   // IMF-fixdate only (the obsolete formats are not generated by current clients)
+
+   static const char* months= "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+   char month[4];
+   struct tm tm;
+
+   memset(&tm, 0, sizeof(tm));
+
+   if (sscanf(value, "%*3s, %2d %3s %4d %2d:%2d:%2d GMT", &tm.tm_mday, month, &tm.tm_year, &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6)
+      return false;
+
+   const char* m= strstr(months, month);
+
+   if (!m || (m - months) % 3)
+      return false;
+
+   tm.tm_mon= (m - months) / 3;
+   tm.tm_year -= 1900;
+
+   result= timegm(&tm);
+
+   return result != (time_t)-1;
+}
+
+//***************************************************************************
+// validators (ETag)
+//***************************************************************************
+
+static std::string entityTag(const struct stat& st)
+{
+   char buf[100];
+   snprintf(buf, sizeof(buf), "\"%llx-%llx-%llx\"", (unsigned long long)st.st_ino, (unsigned long long)st.st_size, (unsigned long long)st.st_mtime);
+
+   return buf;
+}
+
+static bool matchesEntityTag(const char* header, const std::string& tag)
+{
+   // If-None-Match: "*" or a list of (weak) entity tags, compared weakly
+
+   const char* p= header;
+
+   while (*p)
+   {
+      while (*p == ' ' || *p == '\t' || *p == ',')
+         p++;
+
+      if (*p == '*')
+         return true;
+
+      if (!strncmp(p, "W/", 2))
+         p += 2;
+
+      const char* end= *p == '"' ? strchr(p + 1, '"') : nullptr;
+
+      if (!end)
+         return false;
+
+      if ((size_t)(end - p + 1) == tag.size() && !strncmp(p, tag.c_str(), tag.size()))
+         return true;
+
+      p= end + 1;
+   }
+
+   return false;
+}
+
 //***************************************************************************
 // Middleware filesystem
 //***************************************************************************
@@ -53,13 +303,14 @@ MiddlewareFunction filesystem(const std::shared_ptr<FilesystemOptions>& opts)
 
       std::string url(theOpts->rootPath);
       std::string extension;
-      const char* p= req->getUrl();
+      StringView requestUrl= req->url();
+      const char* p= requestUrl.data();
       const char* urlBeg= p;
       const char* middlewarePath= req->getMiddlewarePath() ? req->getMiddlewarePath() : "";
       size_t middlewarePathLen= strlen(middlewarePath);
       MimeType type = std::make_pair("text/plain", false);
 
-      if (!p || !strlen(p))
+      if (requestUrl.empty())
       {
          res->end(404);
          return;
@@ -88,9 +339,9 @@ MiddlewareFunction filesystem(const std::shared_ptr<FilesystemOptions>& opts)
          p++;
       }
 
-      // (2) determine mime type & correctly set Content-Type header
+      // (2) determine mime type for the Content-Type header
 
-      p= req->getUrl() + strlen(req->getUrl()) - 1;
+      p= requestUrl.end() - 1;
 
       while (p >= urlBeg && *p && isalnum(*p) && *p != '.')
          p--;
@@ -98,44 +349,168 @@ MiddlewareFunction filesystem(const std::shared_ptr<FilesystemOptions>& opts)
       if (*p == '.')
          extension= p+1;
 
+      std::string cntType;
+
       if (!extension.empty() && Server::getMimeTypes()->count(extension))
       {
          type= (*Server::getMimeTypes())[extension];
 
-         std::string cntType= type.first;
+         cntType= type.first;
 
          if (!type.second)
          {
             cntType+= "; charset=";
             cntType+= theOpts->defaultEncoding;
          }
-
-         res->set("Content-Type", cntType.c_str());
       }
       else
       {
-         std::string cntType= "text/plain; charset=";
+         cntType= "text/plain; charset=";
          cntType += theOpts->defaultEncoding;
+      }
 
-         res->set("Content-Type", cntType.c_str());
+      // (3) stat the file, respond 404 if it could not be found (or is not a regular file).
+      //     this is only used for the 304 shortcut, the response itself uses the opened file
+
+      struct stat st;
+
+      if (stat(url.c_str(), &st) || !S_ISREG(st.st_mode))
+      {
+         res->end(404);
+         return;
       }
 
-      // (3) open the file using ifstream
+      // (4) validators & conditional requests (GET/HEAD), answered with 304 without opening the file.
+      //     If-Modified-Since is only evaluated without If-None-Match (RFC 7232). compressed
+      //     representations get a weak entity tag, byte ranges (never compressed) a strong one
+
+      Method method= req->getMethod();
+      std::string etag, lastModified;
+      bool compressed= res->getFlags() & Response::fCompression;
 
-      std::ifstream file(url.c_str(), std::ios::in|std::ios::binary);
+      auto setValidators= [&etag, &lastModified, res](bool weak)
+      {
+         if (!etag.empty())
+            res->set("ETag", weak ? ("W/" + etag).c_str() : etag.c_str());
 
-      // (4a) respond 404 if file could not be found
+         if (!lastModified.empty())
+            res->set("Last-Modified", lastModified.c_str());
+      };
 
-      if (!file.is_open() || !file.good())
+      auto getValidators= [&etag, &lastModified, theOpts](const struct stat& st)
       {
+         etag= theOpts->etag ? entityTag(st) : std::string();
+         lastModified= theOpts->lastModified ? httpDate(st.st_mtime) : std::string();
+      };
+
+      getValidators(st);
+
+      if (method == methodGET || method == methodHEAD)
+      {
+         const char* ifNoneMatch= etag.empty() ? nullptr : req->get(hdr::IfNoneMatch);
+         const char* ifModifiedSince= lastModified.empty() ? nullptr : req->get(hdr::IfModifiedSince);
+         time_t since;
+
+         if ((ifNoneMatch && matchesEntityTag(ifNoneMatch, etag))
+               || (!ifNoneMatch && ifModifiedSince && parseHttpDate(ifModifiedSince, since) && st.st_mtime <= since))
+         {
+            setValidators(compressed);
+            res->end(304);
+            return;
+         }
+      }
+
+      // (5) open the file (non-blocking, so a FIFO swapped in does not block the worker). size,
+      //     modification time and validators are taken from the descriptor, as the path may
+      //     have been replaced since (3)
+
+      int fd= open(url.c_str(), O_RDONLY|O_NONBLOCK);
+
+      if (fd < 0 || fstat(fd, &st) || !S_ISREG(st.st_mode))
+      {
+         if (fd >= 0)
+            close(fd);
+
          res->end(404);
          return;
       }
 
-      // (4b) reply with binary data using the stream interface (send chunks)
+      getValidators(st);
+
+      // (6) byte ranges (GET only). the Range header is ignored if If-Range (strong entity tag or
+      //     date) does not match the file, or names a validator which is disabled. ranges are
+      //     always sent uncompressed, seeking into the file
+
+      const char* rangeHeader= method == methodGET ? req->get(hdr::Range) : nullptr;
+      const char* ifRange= req->get(hdr::IfRange);
+      unsigned long long size= st.st_size;
+      std::vector<ByteRange> ranges;
+      RangeResult range= rangeIgnore;
+
+      if (rangeHeader && (!ifRange || (*ifRange == '"' ? !etag.empty() && etag == ifRange : !lastModified.empty() && lastModified == ifRange)))
+         range= parseRanges(rangeHeader, size, ranges);
+
+      res->setStatic("Accept-Ranges", "bytes");
+
+      if (range == rangeUnsatisfiable)
+      {
+         close(fd);
+
+         res->set("Content-Range", ("bytes */" + std::to_string(size)).c_str());
+         res->end(416);
+         return;
+      }
+
+      // (6a) single range: 206 + Content-Range with the file region
+
+      if (range == rangeSatisfiable && ranges.size() == 1)
+      {
+         res->set("Content-Type", cntType.c_str());
+         res->set("Content-Range", contentRange(ranges[0], size).c_str());
+         setValidators(false);
+         res->sendFile(fd, ranges[0].first, ranges[0].last - ranges[0].first + 1, 206);
+         return;
+      }
+
+      // (6b) multiple ranges: multipart/byteranges, each part referencing its file region
+
+      if (range == rangeSatisfiable)
+      {
+         std::string boundary= randomStringHex(16);
+         ResponseBuilder body;
+
+         for (const auto& r : ranges)
+         {
+            body.append("\r\n--" + boundary + "\r\nContent-Type: " + cntType + "\r\nContent-Range: " + contentRange(r, size) + "\r\n\r\n");
+            body.appendFile(fd, r.first, r.last - r.first + 1);
+         }
+
+         body.append("\r\n--" + boundary + "--\r\n");
+         close(fd);
+
+         res->set("Content-Type", ("multipart/byteranges; boundary=" + boundary).c_str());
+         res->setFlags(res->getFlags() & ~Response::fCompression);
+         setValidators(false);
+         res->end(std::move(body), 206);
+         return;
+      }
+
+      res->set("Content-Type", cntType.c_str());
+
+      // (7a) uncompressed: hand the file to the output buffer (sendfile on plain connections, exact Content-Length)
+
+      setValidators(compressed);
+
+      if (!compressed)
+      {
+         res->sendFile(fd, 0, st.st_size, 200);
+         return;
+      }
+
+      // (7b) compressed: reply using the stream interface (send compressed chunks), reading
+      //     from the descriptor opened above
 
-      res->stream(200, &file);
-      file.close();
+      res->stream(200, std::unique_ptr<std::istream>(new FileStream(fd)));
    };
 
    return res;
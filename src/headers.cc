@@ -0,0 +1,144 @@
+//*************************************************************************
+// File headers.cc
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// cex Library well-known HTTP headers
+//*************************************************************************
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include <cex/headers.hpp>
+#include <cctype>
+#include <strings.h>
+
+namespace cex
+{
+namespace hdr
+{
+
+//***************************************************************************
+// definitions
+//***************************************************************************
+
+static const char* names[count]=
+{
+   "Accept",
+   "Accept-Encoding",
+   "Accept-Language",
+   "Authorization",
+   "Cache-Control",
+   "Connection",
+   "Content-Length",
+   "Content-Type",
+   "Cookie",
+   "Expect",
+   "Host",
+   "If-Modified-Since",
+   "If-None-Match",
+   "If-Range",
+   "Origin",
+   "Range",
+   "Referer",
+   "Transfer-Encoding",
+   "Upgrade",
+   "User-Agent",
+   "X-Forwarded-For"
+};
+
+//***************************************************************************
+// find
+//***************************************************************************
+// perfect hash on the length and the first character (plus the 8th character
+// for the Accept-* headers), a single case-insensitive compare verifies the name
+
+Header find(const char* name, size_t len)
+{
+   if (!name || len < 4)
+      return count;
+
+   Header res= count;
+
+   switch (len)
+   {
+      case 4:  res= Host; break;
+      case 5:  res= Range; break;
+      case 8:  res= IfRange; break;
+      case 12: res= ContentType; break;
+      case 14: res= ContentLength; break;
+
+      case 6:
+         switch (tolower(*name))
+         {
+            case 'a': res= Accept; break;
+            case 'c': res= Cookie; break;
+            case 'e': res= Expect; break;
+            case 'o': res= Origin; break;
+         }
+         break;
+
+      case 7:
+         switch (tolower(*name))
+         {
+            case 'r': res= Referer; break;
+            case 'u': res= Upgrade; break;
+         }
+         break;
+
+      case 10:
+         switch (tolower(*name))
+         {
+            case 'c': res= Connection; break;
+            case 'u': res= UserAgent; break;
+         }
+         break;
+
+      case 13:
+         switch (tolower(*name))
+         {
+            case 'a': res= Authorization; break;
+            case 'c': res= CacheControl; break;
+            case 'i': res= IfNoneMatch; break;
+         }
+         break;
+
+      case 15:
+         switch (tolower(*name))
+         {
+            case 'a': res= tolower(name[7]) == 'e' ? AcceptEncoding : AcceptLanguage; break;
+            case 'x': res= XForwardedFor; break;
+         }
+         break;
+
+      case 17:
+         switch (tolower(*name))
+         {
+            case 'i': res= IfModifiedSince; break;
+            case 't': res= TransferEncoding; break;
+         }
+         break;
+
+      default:
+         break;
+   }
+
+   if (res == count || strncasecmp(name, names[res], len))
+      return count;
+
+   return res;
+}
+
+//***************************************************************************
+// name
+//***************************************************************************
+
+const char* name(Header header)
+{
+   return header < count ? names[header] : "";
+}
+
+//***************************************************************************
+} // namespace hdr
+} // namespace cex
@@ -16,6 +16,42 @@
 namespace cex
 {
 
+//***************************************************************************
+// struct Middleware::Stats
+//***************************************************************************
+// counters are sharded by thread, each worker thread (up to shardCount) gets
+// its own shard, so counting does not contend. shards are merged when read.
+
+struct Middleware::Stats
+{
+   static const int shardCount= 16;
+
+   struct Shard
+   {
+      Shard() : matches(0), invocations(0), micros(0)
+      {
+         for (auto& b : histogram)
+            b= 0;
+      }
+
+      std::atomic<unsigned long long> matches;
+      std::atomic<unsigned long long> invocations;
+      std::atomic<unsigned long long> micros;
+      std::atomic<unsigned long long> histogram[MiddlewareStats::bucketCount];
+      char padding[64];
+   };
+
+   Shard& local()
+   {
+      static std::atomic<unsigned> threads(0);
+      static thread_local unsigned shard= threads++ % shardCount;
+
+      return shards[shard];
+   }
+
+   Shard shards[shardCount];
+};
+
 //***************************************************************************
 // class Middleware
 //***************************************************************************
@@ -23,23 +59,41 @@ namespace cex
 //***************************************************************************
 
 Middleware::Middleware(const char* aPath, const MiddlewareFunction& func, int aMethod, int aFlags)
-   : func(func), rep(aPath ? aPath : ".*", std::regex::optimize),
-     method(aMethod), path(aPath ? aPath : ""), flags(aFlags)
+   : func(func), method(aMethod), path(aPath ? aPath : ""), flags(aFlags), maxBodySize(0)
 {
-   if (!aPath)
-      flags= flags & ~fMatching;
-
+   init(aPath);
    type= tpStandard;
 }
 
 Middleware::Middleware(const char* aPath, const UploadFunction& func, int aMethod, int aFlags)
-   : uploadFunc(func), rep(aPath ? aPath : ".*", std::regex::optimize),
-     method(aMethod), path(aPath ? aPath : ""), flags(aFlags)
+   : uploadFunc(func), method(aMethod), path(aPath ? aPath : ""), flags(aFlags), maxBodySize(0)
+{
+   init(aPath);
+   type= tpUpload;
+}
+
+//***************************************************************************
+// init (compile path according to matching flags)
+//***************************************************************************
+
+void Middleware::init(const char* aPath)
 {
    if (!aPath)
+   {
       flags= flags & ~fMatching;
+      return;
+   }
 
-   type= tpUpload;
+   // regular expression/pattern are only compiled if they can actually be used
+   // (same precedence as in match())
+
+   if (flags & (fMatchCompare | fMatchContain))
+      return;
+
+   if (flags & fMatchPattern)
+      pattern= PathPattern(path);
+   else if (flags & fMatchRegex)
+      rep= std::regex(aPath, std::regex::optimize);
 }
 
 //***************************************************************************
@@ -48,7 +102,7 @@ Middleware::Middleware(const char* aPath, const UploadFunction& func, int aMetho
 
 bool Middleware::match(Request* req)
 {
-   if (method != na && method != req->evhtp_method)
+   if (!matchMethod(req))
       return false;
 
    if (!(flags & fMatching))
@@ -60,13 +114,18 @@ bool Middleware::match(Request* req)
    // plain strcmp, faster than regex
 
    if (flags & fMatchCompare)
-      return !strcmp(notNull(req->getUrl()), path.c_str()) ? true : false;
+      return req->url() == StringView(path);
 
    // plain strstr, faster than regex
 
    if (flags & fMatchContain)
       return strstr(notNull(req->getUrl()), path.c_str()) ? true : false;
 
+   // segment-wise pattern matching, no regex involved
+
+   if (flags & fMatchPattern)
+      return pattern.match(req->getUrl(), nullptr);
+
    // full regular expression matching
 
    std::cmatch m;
@@ -75,6 +134,84 @@ bool Middleware::match(Request* req)
    return !m.empty();
 }
 
+//***************************************************************************
+// bind (make the middleware the current one of the request)
+//***************************************************************************
+
+void Middleware::bind(Request* req) const
+{
+   req->middlewarePath= path.c_str();
+
+   if ((flags & fMatchPattern) && !(flags & (fMatchCompare | fMatchContain)))
+      pattern.match(req->getUrl(), &req->params);
+   else
+      req->params.clear();
+}
+
+//***************************************************************************
+// match method
+//***************************************************************************
+
+bool Middleware::matchMethod(Request* req) const
+{
+   return method == na || method == req->evhtp_method;
+}
+
+//***************************************************************************
+// statistics
+//***************************************************************************
+
+void Middleware::enableStats()
+{
+   if (!stats)
+      stats= std::make_shared<Stats>();
+}
+
+void Middleware::countMatch() const
+{
+   if (stats)
+      stats->local().matches.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Middleware::countInvocation(unsigned long long micros) const
+{
+   if (!stats)
+      return;
+
+   Stats::Shard& shard= stats->local();
+   int bucket= 0;
+
+   while (bucket < MiddlewareStats::bucketCount-1 && micros >= (1ULL << bucket))
+      bucket++;
+
+   shard.invocations.fetch_add(1, std::memory_order_relaxed);
+   shard.micros.fetch_add(micros, std::memory_order_relaxed);
+   shard.histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Middleware::getStats(MiddlewareStats& result) const
+{
+   result.path= path;
+   result.method= method;
+   result.matches= result.invocations= result.totalMicros= 0;
+
+   for (auto& b : result.histogram)
+      b= 0;
+
+   if (!stats)
+      return;
+
+   for (const auto& shard : stats->shards)
+   {
+      result.matches += shard.matches.load(std::memory_order_relaxed);
+      result.invocations += shard.invocations.load(std::memory_order_relaxed);
+      result.totalMicros += shard.micros.load(std::memory_order_relaxed);
+
+      for (int i= 0; i < MiddlewareStats::bucketCount; i++)
+         result.histogram[i] += shard.histogram[i].load(std::memory_order_relaxed);
+   }
+}
+
 //***************************************************************************
 } // namespace cex
 
@@ -0,0 +1,915 @@
+//*************************************************************************
+// File regexset.cc
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// cex Library RegexSet class implementation
+//*************************************************************************
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include <cex/regexset.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+
+namespace cex
+{
+
+//***************************************************************************
+// definitions
+//***************************************************************************
+
+static const size_t maxNfaStates= 100000;
+static const int maxRepeat= 1000;
+
+//***************************************************************************
+// syntax tree & NFA fragments
+//***************************************************************************
+
+struct RegexSet::Ast
+{
+   enum Type
+   {
+      tpSet,
+      tpBegin,
+      tpEnd,
+      tpConcat,
+      tpAlt,
+      tpRepeat
+   };
+
+   explicit Ast(Type t= tpConcat) : type(t), min(0), max(0) {}
+
+   Type type;
+   CharSet set;
+   std::vector<Ast> kids;
+   int min;
+   int max;          // -1: unbounded
+};
+
+struct RegexSet::Fragment
+{
+   int start;
+   std::vector<std::pair<int,int>> outs;   // dangling (state, slot)
+};
+
+//***************************************************************************
+// Parser (subset of ECMAScript syntax)
+//***************************************************************************
+
+struct RegexSet::Parser
+{
+   explicit Parser(const std::string& pattern)
+      : p(pattern.c_str()), end(pattern.c_str() + pattern.size()), ok(true) {}
+
+   bool parse(Ast& result)
+   {
+      result= alternation();
+      return ok && p == end;
+   }
+
+   Ast alternation()
+   {
+      Ast res(Ast::tpAlt);
+
+      res.kids.push_back(concatenation());
+
+      while (ok && p < end && *p == '|')
+      {
+         p++;
+         res.kids.push_back(concatenation());
+      }
+
+      if (res.kids.size() == 1)
+      {
+         Ast single(std::move(res.kids[0]));
+         return single;
+      }
+
+      return res;
+   }
+
+   Ast concatenation()
+   {
+      Ast res(Ast::tpConcat);
+
+      while (ok && p < end && *p != '|' && *p != ')')
+         res.kids.push_back(repetition());
+
+      return res;
+   }
+
+   Ast repetition()
+   {
+      Ast atom= this->atom();
+
+      if (!ok || p >= end)
+         return atom;
+
+      int min, max;
+
+      switch (*p)
+      {
+         case '*': min= 0; max= -1; p++; break;
+         case '+': min= 1; max= -1; p++; break;
+         case '?': min= 0; max= 1; p++; break;
+         case '{':
+         {
+            p++;
+            min= number();
+            max= min;
+
+            if (p < end && *p == ',')
+            {
+               p++;
+               max= (p < end && *p == '}') ? -1 : number();
+            }
+
+            if (p >= end || *p != '}' || min < 0 || (max != -1 && max < min) || max > maxRepeat)
+               return fail();
+
+            p++;
+            break;
+         }
+         default:
+            return atom;
+      }
+
+      // non-greedy quantifiers do not change the set of matching strings
+
+      if (p < end && *p == '?')
+         p++;
+
+      if (atom.type == Ast::tpBegin || atom.type == Ast::tpEnd)
+         return fail();
+
+      Ast res(Ast::tpRepeat);
+      res.min= min;
+      res.max= max;
+      res.kids.push_back(std::move(atom));
+
+      return res;
+   }
+
+   Ast atom()
+   {
+      Ast res(Ast::tpSet);
+      char c= *p++;
+
+      switch (c)
+      {
+         case '(':
+         {
+            if (p < end && *p == '?')
+            {
+               // only non-capturing groups, no look-aheads
+
+               if (p+1 >= end || p[1] != ':')
+                  return fail();
+
+               p += 2;
+            }
+
+            res= alternation();
+
+            if (p >= end || *p != ')')
+               return fail();
+
+            p++;
+            return res;
+         }
+
+         case '[':   charClass(res.set); return res;
+         case '\\':  escape(res.set, false); return res;
+         case '^':   return Ast(Ast::tpBegin);
+         case '$':   return Ast(Ast::tpEnd);
+
+         case '.':
+            res.set.set();
+            res.set.reset('\n');
+            res.set.reset('\r');
+            return res;
+
+         case '*': case '+': case '?': case '{': case '}': case ']':
+            return fail();
+
+         default:
+            res.set.set((unsigned char)c);
+            return res;
+      }
+   }
+
+   void charClass(CharSet& set)
+   {
+      bool negate= false;
+
+      if (p < end && *p == '^')
+      {
+         negate= true;
+         p++;
+      }
+
+      while (ok && p < end && *p != ']')
+      {
+         CharSet item;
+         int from= classAtom(item);
+
+         if (from >= 0 && p+1 < end && *p == '-' && p[1] != ']')
+         {
+            p++;
+
+            CharSet upper;
+            int to= classAtom(upper);
+
+            if (to < from)
+            {
+               fail();
+               return;
+            }
+
+            for (int b= from; b <= to; b++)
+               item.set(b);
+         }
+
+         set |= item;
+      }
+
+      if (p >= end)
+      {
+         fail();
+         return;
+      }
+
+      p++;
+
+      if (negate)
+         set.flip();
+   }
+
+   // returns the character for single characters, -1 for classes (\d, ...)
+
+   int classAtom(CharSet& set)
+   {
+      if (*p == '[' && p+1 < end && (p[1] == ':' || p[1] == '=' || p[1] == '.'))
+      {
+         fail();
+         return -1;
+      }
+
+      if (*p == '\\')
+      {
+         p++;
+         return escape(set, true);
+      }
+
+      set.set((unsigned char)*p);
+      return (unsigned char)*p++;
+   }
+
+   int escape(CharSet& set, bool inClass)
+   {
+      if (p >= end)
+      {
+         fail();
+         return -1;
+      }
+
+      char c= *p++;
+      int ch= -1;
+
+      switch (c)
+      {
+         case 'd': case 'D': set |= digits();      if (c == 'D') set.flip(); return -1;
+         case 'w': case 'W': set |= wordChars();   if (c == 'W') set.flip(); return -1;
+         case 's': case 'S': set |= spaces();      if (c == 'S') set.flip(); return -1;
+
+         case 't': ch= '\t'; break;
+         case 'n': ch= '\n'; break;
+         case 'r': ch= '\r'; break;
+         case 'f': ch= '\f'; break;
+         case 'v': ch= '\v'; break;
+         case '0': ch= 0; break;
+         case 'b': if (inClass) { ch= '\b'; break; } fail(); return -1;
+         case 'x': ch= hex(2); break;
+         case 'u': ch= hex(4); break;
+
+         default:
+         {
+            // identity escapes of punctuation only. back references, word boundaries,
+            // control escapes etc. are left to std::regex
+
+            if (isalnum((unsigned char)c))
+            {
+               fail();
+               return -1;
+            }
+
+            ch= (unsigned char)c;
+         }
+      }
+
+      if (ch < 0 || ch > 0x7F)
+      {
+         fail();
+         return -1;
+      }
+
+      set.set(ch);
+      return ch;
+   }
+
+   int number()
+   {
+      int n= 0;
+      const char* start= p;
+
+      while (p < end && *p >= '0' && *p <= '9' && n <= maxRepeat)
+         n= n*10 + (*p++ - '0');
+
+      return p == start ? -1 : n;
+   }
+
+   int hex(int digits)
+   {
+      int n= 0;
+
+      for (int i= 0; i < digits; i++, p++)
+      {
+         if (p >= end || !isxdigit((unsigned char)*p))
+            return -1;
+
+         n= n*16 + (isdigit((unsigned char)*p) ? *p - '0' : (tolower((unsigned char)*p) - 'a' + 10));
+      }
+
+      return n;
+   }
+
+   static CharSet digits()
+   {
+      CharSet s;
+
+      for (int c= '0'; c <= '9'; c++)
+         s.set(c);
+
+      return s;
+   }
+
+   static CharSet wordChars()
+   {
+      CharSet s(digits());
+
+      for (int c= 'a'; c <= 'z'; c++)
+      {
+         s.set(c);
+         s.set(toupper(c));
+      }
+
+      s.set('_');
+      return s;
+   }
+
+   static CharSet spaces()
+   {
+      CharSet s;
+
+      for (int c= '\t'; c <= '\r'; c++)
+         s.set(c);
+
+      s.set(' ');
+      return s;
+   }
+
+   Ast fail()
+   {
+      ok= false;
+      p= end;
+      return Ast();
+   }
+
+   const char* p;
+   const char* end;
+   bool ok;
+};
+
+//***************************************************************************
+// class RegexSet
+//***************************************************************************
+// ctor
+//***************************************************************************
+
+RegexSet::RegexSet()
+{
+   clear();
+}
+
+//***************************************************************************
+// clear
+//***************************************************************************
+
+void RegexSet::clear()
+{
+   nfa.clear();
+   charSets.clear();
+   starts.clear();
+   reinject.clear();
+   dfa.clear();
+   transitions.clear();
+   emptyMatches.clear();
+   classByte.clear();
+
+   compiled= false;
+   useDfa= false;
+   classCount= 0;
+}
+
+//***************************************************************************
+// add
+//***************************************************************************
+
+bool RegexSet::add(const std::string& pattern, size_t id)
+{
+   Ast ast;
+   Parser parser(pattern);
+
+   if (!parser.parse(ast))
+      return false;
+
+   size_t oldStates= nfa.size();
+   size_t oldSets= charSets.size();
+
+   Fragment frag= build(ast);
+
+   if (nfa.size() > maxNfaStates)
+   {
+      nfa.resize(oldStates);
+      charSets.resize(oldSets);
+      return false;
+   }
+
+   int match= newState(stMatch, -1, -1, id);
+
+   for (const auto& o : frag.outs)
+      (o.second ? nfa[o.first].out1 : nfa[o.first].out)= match;
+
+   starts.push_back(frag.start);
+   compiled= false;
+
+   return true;
+}
+
+//***************************************************************************
+// build (Thompson construction)
+//***************************************************************************
+
+int RegexSet::newState(StateType type, int out, int out1, size_t id)
+{
+   State s;
+
+   s.type= type;
+   s.out= out;
+   s.out1= out1;
+   s.id= id;
+
+   nfa.push_back(s);
+
+   return (int)nfa.size() - 1;
+}
+
+RegexSet::Fragment RegexSet::build(const Ast& ast)
+{
+   Fragment res;
+
+   auto patch= [this](const std::vector<std::pair<int,int>>& outs, int target)
+   {
+      for (const auto& o : outs)
+         (o.second ? nfa[o.first].out1 : nfa[o.first].out)= target;
+   };
+
+   auto append= [&patch](Fragment& f, Fragment&& g)
+   {
+      if (f.start < 0)
+      {
+         f= std::move(g);
+         return;
+      }
+
+      patch(f.outs, g.start);
+      f.outs= std::move(g.outs);
+   };
+
+   res.start= -1;
+
+   if (nfa.size() > maxNfaStates)
+   {
+      // abort construction, add() rolls back
+
+      res.start= newState(stEpsilon);
+      res.outs.push_back(std::make_pair(res.start, 0));
+      return res;
+   }
+
+   switch (ast.type)
+   {
+      case Ast::tpSet:
+      {
+         charSets.push_back(ast.set);
+         res.start= newState(stChar, -1, -1, charSets.size()-1);
+         res.outs.push_back(std::make_pair(res.start, 0));
+         break;
+      }
+
+      case Ast::tpBegin:
+      case Ast::tpEnd:
+      {
+         res.start= newState(ast.type == Ast::tpBegin ? stBegin : stEnd);
+         res.outs.push_back(std::make_pair(res.start, 0));
+         break;
+      }
+
+      case Ast::tpConcat:
+      {
+         for (const auto& kid : ast.kids)
+            append(res, build(kid));
+
+         break;
+      }
+
+      case Ast::tpAlt:
+      {
+         res= build(ast.kids.back());
+
+         for (size_t i= ast.kids.size()-1; i-- > 0;)
+         {
+            Fragment f= build(ast.kids[i]);
+            int split= newState(stSplit, f.start, res.start);
+
+            res.start= split;
+            res.outs.insert(res.outs.end(), f.outs.begin(), f.outs.end());
+         }
+
+         break;
+      }
+
+      case Ast::tpRepeat:
+      {
+         const Ast& kid= ast.kids[0];
+
+         for (int i= 0; i < ast.min; i++)
+            append(res, build(kid));
+
+         if (ast.max == -1)
+         {
+            Fragment f= build(kid);
+            Fragment star;
+            int split= newState(stSplit, f.start);
+
+            patch(f.outs, split);
+            star.start= split;
+            star.outs.push_back(std::make_pair(split, 1));
+            append(res, std::move(star));
+         }
+         else if (ast.max > ast.min)
+         {
+            // x{0,n} = (x(x(...)?)?)?, built from the inside out
+
+            Fragment opt;
+            opt.start= -1;
+
+            for (int i= ast.min; i < ast.max; i++)
+            {
+               Fragment f= build(kid);
+
+               if (opt.start >= 0)
+               {
+                  patch(f.outs, opt.start);
+                  f.outs= opt.outs;
+               }
+
+               int split= newState(stSplit, f.start);
+               f.outs.push_back(std::make_pair(split, 1));
+               f.start= split;
+               opt= std::move(f);
+            }
+
+            append(res, std::move(opt));
+         }
+
+         break;
+      }
+   }
+
+   if (res.start < 0)
+   {
+      res.start= newState(stEpsilon);
+      res.outs.push_back(std::make_pair(res.start, 0));
+   }
+
+   return res;
+}
+
+//***************************************************************************
+// closure (follow epsilon transitions & assertions)
+//***************************************************************************
+
+void RegexSet::closure(std::vector<int>& set, bool atStart, bool atEnd, std::vector<unsigned>& marks, unsigned mark) const
+{
+   static thread_local std::vector<int> stack;
+
+   stack.assign(set.begin(), set.end());
+   set.clear();
+
+   while (!stack.empty())
+   {
+      int s= stack.back();
+      stack.pop_back();
+
+      if (s < 0 || marks[s] == mark)
+         continue;
+
+      marks[s]= mark;
+
+      const State& st= nfa[s];
+
+      switch (st.type)
+      {
+         case stChar:
+         case stMatch:
+            set.push_back(s);
+            break;
+
+         case stEnd:
+            if (atEnd)
+               stack.push_back(st.out);
+            else
+               set.push_back(s);   // keep, the assertion might hold at the end of the input
+            break;
+
+         case stBegin:
+            if (atStart)
+               stack.push_back(st.out);
+            break;
+
+         case stEpsilon:
+            stack.push_back(st.out);
+            break;
+
+         case stSplit:
+            stack.push_back(st.out1);
+            stack.push_back(st.out);
+            break;
+      }
+   }
+}
+
+//***************************************************************************
+// step (advance a state set by one input byte class)
+//***************************************************************************
+
+void RegexSet::step(const std::vector<int>& from, int cls, std::vector<int>& to, std::vector<unsigned>& marks, unsigned& mark) const
+{
+   unsigned char byte= classByte[cls];
+
+   to.clear();
+
+   for (int s : from)
+   {
+      if (nfa[s].type == stChar && charSets[nfa[s].id][byte])
+         to.push_back(nfa[s].out);
+   }
+
+   // search semantics: a match may start at every position
+
+   to.insert(to.end(), reinject.begin(), reinject.end());
+
+   if (!++mark)
+   {
+      std::fill(marks.begin(), marks.end(), 0);
+      mark= 1;
+   }
+
+   closure(to, false, false, marks, mark);
+}
+
+//***************************************************************************
+// collect ids of the match states of a state set
+//***************************************************************************
+
+void RegexSet::collect(const std::vector<int>& set, std::vector<size_t>& ids, bool atEnd) const
+{
+   if (atEnd)
+   {
+      std::vector<int> endSet(set);
+      std::vector<unsigned> marks(nfa.size(), 0);
+
+      closure(endSet, false, true, marks, 1);
+      collect(endSet, ids, false);
+      return;
+   }
+
+   for (int s : set)
+   {
+      if (nfa[s].type == stMatch)
+         ids.push_back(nfa[s].id);
+   }
+}
+
+//***************************************************************************
+// compile
+//***************************************************************************
+
+void RegexSet::compile()
+{
+   std::vector<unsigned> marks(nfa.size(), 0);
+   unsigned mark= 1;
+
+   dfa.clear();
+   transitions.clear();
+   emptyMatches.clear();
+   compiled= true;
+   useDfa= true;
+
+   if (starts.empty())
+      return;
+
+   // (1) partition the bytes into classes which no character set distinguishes
+
+   memset(byteClass, 0, sizeof(byteClass));
+   classCount= 1;
+
+   for (const auto& cs : charSets)
+   {
+      std::vector<int> remap(classCount*2, -1);
+      int n= 0;
+
+      for (int b= 0; b < 256; b++)
+      {
+         int key= byteClass[b]*2 + (cs[b] ? 1 : 0);
+
+         if (remap[key] < 0)
+            remap[key]= n++;
+
+         byteClass[b]= remap[key];
+      }
+
+      classCount= n;
+   }
+
+   classByte.assign(classCount, 0);
+
+   for (int b= 255; b >= 0; b--)
+      classByte[byteClass[b]]= (unsigned char)b;
+
+   // (2) initial state (begin of input), states re-injected at every position, empty input
+
+   std::vector<int> initial(starts);
+   closure(initial, true, false, marks, mark++);
+   std::sort(initial.begin(), initial.end());
+
+   reinject= starts;
+   closure(reinject, false, false, marks, mark++);
+
+   std::vector<int> empty(starts);
+   closure(empty, true, true, marks, mark++);
+   collect(empty, emptyMatches, false);
+
+   // (3) subset construction
+
+   std::map<std::vector<int>, int> index;
+   std::vector<int> next;
+
+   dfa.push_back(DfaState());
+   dfa[0].states= initial;
+   index[initial]= 0;
+
+   for (size_t i= 0; i < dfa.size(); i++)
+   {
+      transitions.resize((i+1) * classCount, -1);
+
+      for (int cls= 0; cls < classCount; cls++)
+      {
+         step(dfa[i].states, cls, next, marks, mark);
+         std::sort(next.begin(), next.end());
+
+         auto it= index.find(next);
+
+         if (it == index.end())
+         {
+            if (dfa.size() >= maxStates)
+            {
+               // too large, fall back to NFA simulation
+
+               dfa.clear();
+               transitions.clear();
+               useDfa= false;
+               return;
+            }
+
+            it= index.insert(std::make_pair(next, (int)dfa.size())).first;
+            dfa.push_back(DfaState());
+            dfa.back().states= next;
+         }
+
+         transitions[i*classCount + cls]= it->second;
+      }
+   }
+
+   for (auto& state : dfa)
+   {
+      collect(state.states, state.matches, false);
+      collect(state.states, state.endMatches, true);
+   }
+}
+
+//***************************************************************************
+// match
+//***************************************************************************
+
+void RegexSet::match(const char* text, std::vector<size_t>& ids) const
+{
+   if (!compiled || starts.empty() || !text)
+      return;
+
+   if (!*text)
+   {
+      ids.insert(ids.end(), emptyMatches.begin(), emptyMatches.end());
+      return;
+   }
+
+   if (!useDfa)
+   {
+      simulate(text, ids);
+      return;
+   }
+
+   // report the matches of each visited DFA state once
+
+   static thread_local std::vector<unsigned> seen;
+   static thread_local unsigned generation= 0;
+
+   if (seen.size() < dfa.size())
+      seen.resize(dfa.size(), 0);
+
+   if (!++generation)
+   {
+      std::fill(seen.begin(), seen.end(), 0);
+      generation= 1;
+   }
+
+   int state= 0;
+
+   for (const char* p= text; ; p++)
+   {
+      if (seen[state] != generation)
+      {
+         seen[state]= generation;
+         ids.insert(ids.end(), dfa[state].matches.begin(), dfa[state].matches.end());
+      }
+
+      if (!*p)
+         break;
+
+      state= transitions[state*classCount + byteClass[(unsigned char)*p]];
+   }
+
+   ids.insert(ids.end(), dfa[state].endMatches.begin(), dfa[state].endMatches.end());
+}
+
+//***************************************************************************
+// simulate (NFA set simulation, used if the DFA would be too large)
+//***************************************************************************
+
+void RegexSet::simulate(const char* text, std::vector<size_t>& ids) const
+{
+   static thread_local std::vector<unsigned> marks;
+   static thread_local unsigned mark= 0;
+   static thread_local std::vector<int> current, next;
+
+   if (marks.size() < nfa.size())
+      marks.resize(nfa.size(), 0);
+
+   if (!++mark)
+   {
+      std::fill(marks.begin(), marks.end(), 0);
+      mark= 1;
+   }
+
+   current= starts;
+   closure(current, true, false, marks, mark);
+   collect(current, ids, false);
+
+   for (const char* p= text; *p; p++)
+   {
+      step(current, byteClass[(unsigned char)*p], next, marks, mark);
+      current.swap(next);
+      collect(current, ids, false);
+   }
+
+   collect(current, ids, true);
+}
+
+//***************************************************************************
+} // namespace cex
@@ -12,32 +12,209 @@
 
 #include <cex/core.hpp>
 #include <cex/util.hpp>
+#include <algorithm>
+#include <cstring>
 
 namespace cex
 {
 
+//***************************************************************************
+// definitions
+//***************************************************************************
+
+static const size_t maxPropertyShims= 64;
+
+static std::atomic<size_t> slotsReserved(0);
+
+static std::vector<Request::PropertyShim>& propertyShims()
+{
+   static std::vector<Request::PropertyShim> shims;
+   return shims;
+}
+
+//***************************************************************************
+// class SlotRegistry
+//***************************************************************************
+
+size_t SlotRegistry::reserve()
+{
+   return slotsReserved++;
+}
+
+size_t SlotRegistry::count()
+{
+   return slotsReserved.load(std::memory_order_relaxed);
+}
+
 //***************************************************************************
 // class Request
 //***************************************************************************
 // ctor/dtor
 //***************************************************************************
 
-Request::Request(evhtp_request* req) 
-   : req(req)
+Request::Request(evhtp_request* req, Arena* aArena) 
+   : req(req), ownArena(aArena ? nullptr : new Arena), arena(aArena ? aArena : ownArena.get()),
+     parsed(0), port(na), hostName(""), hostLength(0),
+     method(unknownMethod), protocol(unknownProtocol), urlLength(0), pathLength(0), middlewarePath(""), body(ArenaAllocator<char>(arena)),
+     bodyBuffer(nullptr), segments(ArenaAllocator<StringView>(arena)), slots(nullptr), slotCount(0), shimsDone(0)
 {
+   slotCount= SlotRegistry::count();
+
+   if (slotCount)
+   {
+      slots= (SlotEntry*)arena->allocate(slotCount * sizeof(SlotEntry), alignof(SlotEntry));
+      memset(slots, 0, slotCount * sizeof(SlotEntry));
+   }
+
+   properties.setResolver(&Request::resolveProperty, this);
+
    parse();
 }
 
+Request::~Request()
+{
+   for (size_t i= 0; i < slotCount; i++)
+      clearSlot(slots[i]);
+}
+
+//***************************************************************************
+// slots
+//***************************************************************************
+
+Request::SlotEntry& Request::slotEntry(size_t index)
+{
+   if (index >= slotCount)
+   {
+      // slot reserved after the request was created (e. g. by a library loaded later)
+
+      size_t count= std::max(index + 1, SlotRegistry::count());
+      SlotEntry* grown= (SlotEntry*)arena->allocate(count * sizeof(SlotEntry), alignof(SlotEntry));
+
+      if (slotCount)
+         memcpy(grown, slots, slotCount * sizeof(SlotEntry));
+
+      memset(grown + slotCount, 0, (count - slotCount) * sizeof(SlotEntry));
+
+      slots= grown;
+      slotCount= count;
+   }
+
+   return slots[index];
+}
+
+void Request::clearSlot(SlotEntry& entry)
+{
+   if (entry.value && entry.destroy)
+      entry.destroy(entry.value);
+
+   entry.value= nullptr;
+   entry.destroy= nullptr;
+}
+
+//***************************************************************************
+// property shims
+//***************************************************************************
+
+bool Request::registerPropertyShim(PropertyShim shim)
+{
+   std::vector<PropertyShim>& shims= propertyShims();
+
+   if (!shim || shims.size() >= maxPropertyShims)
+      return false;
+
+   shims.push_back(shim);
+
+   return true;
+}
+
+bool Request::resolveProperty(void* owner, StringView key)
+{
+   Request* request= (Request*)owner;
+   std::vector<PropertyShim>& shims= propertyShims();
+
+   for (size_t i= 0; i < shims.size(); i++)
+   {
+      // each shim materializes its properties at most once, so removed properties stay removed
+
+      unsigned long long bit= 1ULL << i;
+
+      if (request->shimsDone & bit)
+         continue;
+
+      if (shims[i](request, key))
+      {
+         request->shimsDone |= bit;
+         return true;
+      }
+   }
+
+   return false;
+}
+
 //***************************************************************************
 // get (header value)
 //***************************************************************************
 
 const char* Request::get(const char* headerName) 
 { 
+   evhtp_kv_t* kv= findHeader(headerName);
+
+   return kv ? kv->val : nullptr;
+}
+
+const char* Request::get(hdr::Header header)
+{
+   if (header >= hdr::count)
+      return nullptr;
+
+   if (!(parsed & pfHeaders))
+      indexHeaders();
+
+   return headers[header] ? headers[header]->val : nullptr;
+}
+
+//***************************************************************************
+// header index
+//***************************************************************************
+// a single pass over the headers records the well-known ones, so their
+// lookups do not walk the list with case-insensitive compares
+
+void Request::indexHeaders() const
+{
+   memset(headers, 0, sizeof(headers));
+   parsed |= pfHeaders;
+
    if (!req || !req->headers_in)
+      return;
+
+   evhtp_kv_t* kv;
+
+   TAILQ_FOREACH(kv, req->headers_in, next)
+   {
+      if (!kv->key)
+         continue;
+
+      hdr::Header header= hdr::find(kv->key, kv->klen);
+
+      if (header != hdr::count && !headers[header])
+         headers[header]= kv;
+   }
+}
+
+evhtp_kv_t* Request::findHeader(const char* name) const
+{
+   if (!req || !req->headers_in || !name)
       return nullptr;
 
-   return evhtp_header_find(req->headers_in, headerName);
+   hdr::Header header= hdr::find(name, strlen(name));
+
+   if (header == hdr::count)
+      return evhtp_kvs_find_kv(req->headers_in, name);
+
+   if (!(parsed & pfHeaders))
+      indexHeaders();
+
+   return headers[header];
 }
 
 //***************************************************************************
@@ -98,32 +275,80 @@ int Request::keyValueIteratorCb(evhtp_kv_t * kv, void * arg)
 
 const char* Request::getBody()
 {
-   return body.data();
+   if (!bodyBuffer)
+      return body.data();
+
+   // linearize (only copies if the body is spread across several chains)
+
+   return (const char*)evbuffer_pullup(bodyBuffer, -1);
 }
 
 size_t Request::getBodyLength()
 {
-   return body.size();
+   return bodyBuffer ? evbuffer_get_length(bodyBuffer) : body.size();
+}
+
+const BodySegments& Request::bodySegments()
+{
+   segments.clear();
+
+   if (!bodyBuffer)
+   {
+      if (!body.empty())
+         segments.emplace_back(body.data(), body.size());
+
+      return segments;
+   }
+
+   int count= evbuffer_peek(bodyBuffer, -1, nullptr, nullptr, 0);
+
+   if (count <= 0)
+      return segments;
+
+   segments.reserve(count);
+
+   evbuffer_iovec* vec= (evbuffer_iovec*)arena->allocate(count * sizeof(evbuffer_iovec), alignof(evbuffer_iovec));
+
+   count= evbuffer_peek(bodyBuffer, -1, nullptr, vec, count);
+
+   for (int i= 0; i < count; i++)
+      segments.emplace_back((const char*)vec[i].iov_base, vec[i].iov_len);
+
+   arena->deallocate(vec, count * sizeof(evbuffer_iovec));
+
+   return segments;
 }
 
 int Request::getPort() const
 {
+   if (!(parsed & pfHost))
+      parseHost();
+
    return port;
 }
 
 Method Request::getMethod() 
 { 
+   if (!(parsed & pfMethod))
+      parseMethod();
+
    return method;
 }
 
 Protocol Request::getProtocol() 
 { 
+   if (!(parsed & pfMethod))
+      parseMethod();
+
    return protocol;
 }
 
 const char* Request::getHost() 
 { 
-   return host.c_str();
+   if (!(parsed & pfHost))
+      parseHost();
+
+   return hostName;
 }
 
 const char* Request::getUrl() 
@@ -143,7 +368,82 @@ const char* Request::getFile()
 
 const char* Request::getMiddlewarePath() 
 { 
-   return middlewarePath.c_str();
+   return middlewarePath;
+}
+
+//***************************************************************************
+// views (lengths are computed once)
+//***************************************************************************
+
+StringView Request::url() const
+{
+   if (!uri || !uri->full)
+      return StringView("", 0);
+
+   if (!(parsed & pfUrl))
+   {
+      urlLength= strlen(uri->full);
+      parsed |= pfUrl;
+   }
+
+   return StringView(uri->full, urlLength);
+}
+
+StringView Request::path() const
+{
+   if (!uri || !uri->path)
+      return StringView("", 0);
+
+   if (!(parsed & pfPath))
+   {
+      pathLength= strlen(uri->path);
+      parsed |= pfPath;
+   }
+
+   return StringView(uri->path, pathLength);
+}
+
+StringView Request::host() const
+{
+   if (!(parsed & pfHost))
+      parseHost();
+
+   return StringView(hostName, hostLength);
+}
+
+StringView Request::header(const char* name) const
+{
+   evhtp_kv_t* kv= findHeader(name);
+
+   return kv && kv->val ? StringView(kv->val, kv->vlen) : StringView();
+}
+
+StringView Request::header(hdr::Header header) const
+{
+   if (header >= hdr::count)
+      return StringView();
+
+   if (!(parsed & pfHeaders))
+      indexHeaders();
+
+   evhtp_kv_t* kv= headers[header];
+
+   return kv && kv->val ? StringView(kv->val, kv->vlen) : StringView();
+}
+
+//***************************************************************************
+// get path parameter
+//***************************************************************************
+
+StringView Request::getParam(const char* name) const
+{
+   for (const auto& param : params)
+   {
+      if (param.first == name)
+         return param.second;
+   }
+
+   return StringView();
 }
 
 //***************************************************************************
@@ -152,14 +452,20 @@ const char* Request::getMiddlewarePath()
 
 void Request::parse()
 {
-   // need some additional parsing on top of libevhtp
-
-   port= na;
-   method= unknownMethod;
+   // only what is needed for routing. everything else is parsed on first access
 
    uri= req->uri && req->uri->path ? req->uri->path : nullptr;
    authority= req->uri ? req->uri->authority : nullptr;
    evhtp_method= req->method;
+}
+
+//***************************************************************************
+// parse method & protocol
+//***************************************************************************
+
+void Request::parseMethod() const
+{
+   method= unknownMethod;
 
    switch (evhtp_method)
    {
@@ -190,22 +496,30 @@ void Request::parse()
    else
       protocol= unknownProtocol;
 
-   // parse host
+   parsed |= pfMethod;
+}
 
-   const char* hostHeader= get("Host");
+//***************************************************************************
+// parse host & port
+//***************************************************************************
 
-   if (hostHeader)
-   {
-      const char* p= strchr(hostHeader, ':');
+void Request::parseHost() const
+{
+   StringView hostHeader= header(hdr::Host);
+   const char* p= hostHeader.empty() ? nullptr : (const char*)memchr(hostHeader.data(), ':', hostHeader.size());
 
-      if (p)
-      {
-         port= atoi(p+1);
-         host.assign(hostHeader, p-hostHeader);
-      }
-      else
-         host.assign(hostHeader);
+   port= na;
+   hostName= hostHeader.data() ? hostHeader.data() : "";      // owned by libevhtp, valid for the lifetime of the request
+   hostLength= hostHeader.size();
+
+   if (p)
+   {
+      port= atoi(p+1);
+      hostLength= p - hostHeader.data();
+      hostName= arena->strdup(hostHeader.data(), hostLength);
    }
+
+   parsed |= pfHost;
 }
 
 //***************************************************************************
@@ -14,8 +14,122 @@
 #include <cex/ssl.hpp>
 #include <cex/util.hpp>
 
+#include <unistd.h>
+
 namespace cex
 {
+//***************************************************************************
+// class HeaderBlock
+//***************************************************************************
+
+HeaderBlock::HeaderBlock(std::initializer_list<std::pair<const char*, const char*>> list)
+{
+   headers.reserve(list.size());
+
+   for (const auto& header : list)
+      headers.emplace_back(notNull(header.first), notNull(header.second));
+}
+
+//***************************************************************************
+// class ResponseBuilder
+//***************************************************************************
+
+template<typename T>
+static void releaseOwned(const void* data, size_t len, void* owner)
+{
+   delete (T*)owner;
+}
+
+ResponseBuilder::ResponseBuilder()
+   : chain(evbuffer_new())
+{
+}
+
+ResponseBuilder::ResponseBuilder(ResponseBuilder&& other)
+   : chain(other.chain)
+{
+   other.chain= nullptr;
+}
+
+ResponseBuilder::~ResponseBuilder()
+{
+   // releases all fragments which were not sent
+
+   if (chain)
+      evbuffer_free(chain);
+}
+
+ResponseBuilder& ResponseBuilder::append(std::shared_ptr<const Buffer> fragment)
+{
+   if (!chain || !fragment || fragment->empty())
+      return *this;
+
+   auto owned= new std::shared_ptr<const Buffer>(std::move(fragment));
+
+   if (evbuffer_add_reference(chain, (*owned)->data(), (*owned)->size(), &releaseOwned<std::shared_ptr<const Buffer>>, owned))
+      delete owned;
+
+   return *this;
+}
+
+ResponseBuilder& ResponseBuilder::append(std::string&& part)
+{
+   if (!chain || part.empty())
+      return *this;
+
+   std::string* owned= new std::string(std::move(part));
+
+   if (evbuffer_add_reference(chain, owned->data(), owned->size(), &releaseOwned<std::string>, owned))
+      delete owned;
+
+   return *this;
+}
+
+ResponseBuilder& ResponseBuilder::append(const char* data, size_t len)
+{
+   if (chain && data && len)
+      evbuffer_add(chain, data, len);
+
+   return *this;
+}
+
+ResponseBuilder& ResponseBuilder::appendStatic(const char* data, size_t len)
+{
+   if (chain && data && len)
+      evbuffer_add_reference(chain, data, len, nullptr, nullptr);
+
+   return *this;
+}
+
+ResponseBuilder& ResponseBuilder::appendFile(int fd, off_t offset, size_t len)
+{
+   if (!chain || fd < 0 || !len)
+      return *this;
+
+   int segmentFd= dup(fd);
+
+   if (segmentFd < 0)
+      return *this;
+
+   evbuffer_file_segment* segment= evbuffer_file_segment_new(segmentFd, offset, len, EVBUF_FS_CLOSE_ON_FREE);
+
+   if (!segment)
+   {
+      close(segmentFd);
+      return *this;
+   }
+
+   evbuffer_add_file_segment(chain, segment, 0, len);
+   evbuffer_file_segment_free(segment);
+
+   return *this;
+}
+
+size_t ResponseBuilder::size() const
+{
+   return chain ? evbuffer_get_length(chain) : 0;
+}
+
 //***************************************************************************
 // class Response
 //***************************************************************************
@@ -23,11 +137,19 @@ namespace cex
 //***************************************************************************
 
 Response::Response(evhtp_request* req)
-   : req(req), state(stInit) 
+   : req(req), state(stInit), watermark(STREAM_WATERMARK)
 {
    flags= 0;
 }
 
+Response::~Response()
+{
+   // request finished before the stream was completely sent (e.g. connection closed)
+
+   if (streaming)
+      stopStreaming();
+}
+
 void Response::set(const char* headerName, const char* headerValue)
 {
    if (!req || !req->headers_out)
@@ -49,6 +171,25 @@ void Response::set(const char* headerName, int headerValue)
    evhtp_header_val_add(req->headers_out, number, 1);
 }
 
+void Response::setStatic(const char* headerName, const char* headerValue)
+{
+   if (!req || !req->headers_out)
+      return;
+
+   // no-alloc flags: the header references the strings instead of copying them
+
+   evhtp_headers_add_header(req->headers_out, evhtp_header_new(headerName, headerValue, 0, 0));
+}
+
+void Response::set(const HeaderBlock& block)
+{
+   if (!req || !req->headers_out)
+      return;
+
+   for (const auto& header : block.headers)
+      evhtp_headers_add_header(req->headers_out, evhtp_header_new(header.first.c_str(), header.second.c_str(), 0, 0));
+}
+
 //***************************************************************************
 // end (sent response payload)
 //***************************************************************************
@@ -75,7 +216,7 @@ int Response::end(const char* buf, size_t bufLen, int status)
    if (flags & fCompression)
    {
       compress((char*)buf, bufLen, buffer, flags & fCompressGZip ? cmGZip : cmDeflate);
-      set("Content-Encoding", flags & fCompressGZip ? "gzip" : "deflate");
+      setStatic("Content-Encoding", flags & fCompressGZip ? "gzip" : "deflate");
    }
    else
 #endif
@@ -91,6 +232,166 @@ int Response::end(const char* buf, size_t bufLen, int status)
    return done;
 }
 
+//***************************************************************************
+// end (owned/shared payloads, handed to the evbuffer without copying)
+//***************************************************************************
+
+int Response::end(std::string&& string, int status)
+{
+   std::string* owned= new std::string(std::move(string));
+
+   return endReference(owned->data(), owned->size(), &releaseOwned<std::string>, owned, status);
+}
+
+int Response::end(std::vector<char>&& buffer, int status)
+{
+   std::vector<char>* owned= new std::vector<char>(std::move(buffer));
+
+   return endReference(owned->data(), owned->size(), &releaseOwned<std::vector<char>>, owned, status);
+}
+
+int Response::end(std::shared_ptr<const Buffer> buffer, int status)
+{
+   if (!buffer)
+      return end(status);
+
+   // the evbuffer holds a reference to the shared buffer until the data was sent
+
+   auto owned= new std::shared_ptr<const Buffer>(std::move(buffer));
+
+   return endReference((*owned)->data(), (*owned)->size(), &releaseOwned<std::shared_ptr<const Buffer>>, owned, status);
+}
+
+int Response::endReference(const char* data, size_t len, ReleaseFunction release, void* owner, int status)
+{
+   if (state == stDone || !len)
+   {
+      release(data, len, owner);
+      return end(status);
+   }
+
+   auto* buffer= req->buffer_out;
+
+   if (!buffer)
+   {
+      release(data, len, owner);
+      return fail;
+   }
+
+#ifdef CEX_WITH_ZLIB
+   if (flags & fCompression)
+   {
+      compress(data, len, buffer, flags & fCompressGZip ? cmGZip : cmDeflate);
+      setStatic("Content-Encoding", flags & fCompressGZip ? "gzip" : "deflate");
+      release(data, len, owner);
+   }
+   else
+#endif
+   {
+      if (evbuffer_add_reference(buffer, data, len, release, owner))
+      {
+         release(data, len, owner);
+         return fail;
+      }
+   }
+
+   evhtp_send_reply_start(req, status);
+   evhtp_send_reply_body(req, buffer);
+   evhtp_send_reply_end(req);
+
+   state= stDone;
+   return done;
+}
+
+//***************************************************************************
+// end (scatter-gather payloads)
+//***************************************************************************
+
+int Response::end(const struct iovec* parts, size_t n, int status)
+{
+   if (state == stDone)
+      return done;
+
+   auto* buffer= req->buffer_out;
+
+   if (!buffer || (!parts && n))
+      return fail;
+
+#ifdef CEX_WITH_ZLIB
+   if (flags & fCompression)
+   {
+      StreamCompressor compressor(flags & fCompressGZip ? cmGZip : cmDeflate);
+
+      for (size_t i= 0; i < n; i++)
+         compressor.write((const char*)parts[i].iov_base, parts[i].iov_len, buffer);
+
+      compressor.finish(buffer);
+      setStatic("Content-Encoding", flags & fCompressGZip ? "gzip" : "deflate");
+   }
+   else
+#endif
+   {
+      for (size_t i= 0; i < n; i++)
+         evbuffer_add(buffer, parts[i].iov_base, parts[i].iov_len);
+   }
+
+   evhtp_send_reply_start(req, status);
+   evhtp_send_reply_body(req, buffer);
+   evhtp_send_reply_end(req);
+
+   state= stDone;
+   return done;
+}
+
+int Response::end(ResponseBuilder&& builder, int status)
+{
+   if (state == stDone)
+      return done;
+
+   auto* buffer= req->buffer_out;
+
+   if (!buffer || !builder.chain)
+      return fail;
+
+#ifdef CEX_WITH_ZLIB
+   if (flags & fCompression)
+   {
+      // compress segment by segment, then release the fragments
+
+      StreamCompressor compressor(flags & fCompressGZip ? cmGZip : cmDeflate);
+      struct evbuffer_ptr pos;
+      struct evbuffer_iovec vec;
+
+      evbuffer_ptr_set(builder.chain, &pos, 0, EVBUFFER_PTR_SET);
+
+      while (evbuffer_peek(builder.chain, -1, &pos, &vec, 1) > 0)
+      {
+         compressor.write((const char*)vec.iov_base, vec.iov_len, buffer);
+
+         if (evbuffer_ptr_set(builder.chain, &pos, vec.iov_len, EVBUFFER_PTR_ADD))
+            break;
+      }
+
+      compressor.finish(buffer);
+      evbuffer_drain(builder.chain, evbuffer_get_length(builder.chain));
+      setStatic("Content-Encoding", flags & fCompressGZip ? "gzip" : "deflate");
+   }
+   else
+#endif
+   {
+      // moves the chain, referenced fragments stay referenced until sent
+
+      evbuffer_add_buffer(buffer, builder.chain);
+   }
+
+   evhtp_send_reply_start(req, status);
+   evhtp_send_reply_body(req, buffer);
+   evhtp_send_reply_end(req);
+
+   state= stDone;
+   return done;
+}
+
 int Response::end(int status)
 {
    if (state == stDone)
@@ -131,7 +432,7 @@ int Response::stream(int status, std::istream* stream)
          evbuffer_drain(sendBuffer, bufLen);
       };
 
-      set("Content-Encoding", flags & fCompressGZip ? "gzip" : "deflate");
+      setStatic("Content-Encoding", flags & fCompressGZip ? "gzip" : "deflate");
 
       evhtp_send_reply_chunk_start(req, EVHTP_RES_OK);
       compress(stream, onChunk, (flags & fCompressGZip) ? cmGZip : cmDeflate);
@@ -164,6 +465,232 @@ int Response::stream(int status, std::istream* stream)
    return done;
 }
 
+//***************************************************************************
+// suspend (complete the request asynchronously, see AsyncHandle)
+//***************************************************************************
+
+AsyncHandlePtr Response::suspend()
+{
+   // the request context is the cb-argument of the evhtp_hook_on_request_fini-hook
+
+   Server::Context* ctx= req && req->hooks ? (Server::Context*)req->hooks->on_request_fini_arg : nullptr;
+
+   if (!ctx || state == stDone)
+      return nullptr;
+
+   if (!ctx->async)
+      ctx->async.reset(new AsyncHandle(ctx, req));
+
+   // pausing stops libevhtp from parsing further (pipelined) requests of the connection
+
+   if (!ctx->async->paused)
+   {
+      evhtp_request_pause(req);
+      ctx->async->paused= true;
+   }
+
+   return ctx->async;
+}
+
+//***************************************************************************
+// stream (owned stream, paused at the output buffer watermark)
+//***************************************************************************
+
+struct Response::StreamState
+{
+   std::unique_ptr<std::istream> stream;
+   evbuffer* chunk;
+   evhtp_connection_t* conn;
+   bool hooked;              // write hook & watermark installed on the connection
+#ifdef CEX_WITH_ZLIB
+   std::unique_ptr<StreamCompressor> compressor;
+   std::unique_ptr<char[]> input;
+#endif
+
+   StreamState() : chunk(evbuffer_new()), conn(nullptr), hooked(false) {}
+   ~StreamState() { evhtp_safe_free(chunk, evbuffer_free); }
+};
+
+int Response::stream(int status, std::unique_ptr<std::istream> stream)
+{
+   if (state == stDone)
+      return done;
+
+   if (!stream || !stream->good())
+   {
+      end(status);
+      return fail;
+   }
+
+   streaming.reset(new StreamState());
+   streaming->stream= std::move(stream);
+   streaming->conn= evhtp_request_get_connection(req);
+
+#ifdef CEX_WITH_ZLIB
+   if (flags & fCompression)
+   {
+      streaming->compressor.reset(new StreamCompressor((flags & fCompressGZip) ? cmGZip : cmDeflate));
+      streaming->input.reset(new char[IO_BUFFER_SIZE]);
+
+      setStatic("Content-Encoding", flags & fCompressGZip ? "gzip" : "deflate");
+   }
+#endif
+
+   // resume whenever the client received half of the watermark
+
+   if (watermark && streaming->conn)
+   {
+      bufferevent_setwatermark(evhtp_connection_get_bev(streaming->conn), EV_WRITE, watermark/2, 0);
+      evhtp_connection_set_hook(streaming->conn, evhtp_hook_on_write, (evhtp_hook)Response::handleWrite, this);
+      streaming->hooked= true;
+   }
+
+   state= stDone;
+
+   evhtp_send_reply_chunk_start(req, status);
+   pump();
+
+   return done;
+}
+
+evhtp_res Response::handleWrite(evhtp_connection_t* conn, void* arg)
+{
+   auto res= reinterpret_cast<Response*>(arg);
+
+   if (res && res->streaming)
+      res->pump();
+
+   return EVHTP_RES_OK;
+}
+
+void Response::pump()
+{
+   struct evbuffer* output= streaming->conn ? bufferevent_get_output(evhtp_connection_get_bev(streaming->conn)) : nullptr;
+   std::istream* stream= streaming->stream.get();
+   evbuffer* chunk= streaming->chunk;
+
+   // read & send chunks until the output buffer is above the watermark
+
+   while (!stream->eof() && stream->good())
+   {
+      if (watermark && output && evbuffer_get_length(output) >= watermark)
+         return;
+
+#ifdef CEX_WITH_ZLIB
+      if (streaming->compressor)
+      {
+         stream->read(streaming->input.get(), IO_BUFFER_SIZE);
+         streaming->compressor->write(streaming->input.get(), stream->gcount(), chunk);
+      }
+      else
+#endif
+      {
+         struct evbuffer_iovec vec;
+
+         if (evbuffer_reserve_space(chunk, IO_BUFFER_SIZE, &vec, 1) < 1)
+            break;
+
+         stream->read((char*)vec.iov_base, IO_BUFFER_SIZE);
+         vec.iov_len= stream->gcount();
+         evbuffer_commit_space(chunk, &vec, 1);
+      }
+
+      evhtp_send_reply_chunk(req, chunk);
+      evbuffer_drain(chunk, evbuffer_get_length(chunk));
+   }
+
+#ifdef CEX_WITH_ZLIB
+   if (streaming->compressor)
+   {
+      streaming->compressor->finish(chunk);
+      evhtp_send_reply_chunk(req, chunk);
+   }
+#endif
+
+   // completing the reply may finish the request (and destruct this response),
+   // so all state is released beforehand
+
+   evhtp_request* thisReq= req;
+
+   stopStreaming();
+   evhtp_send_reply_chunk_end(thisReq);
+}
+
+void Response::stopStreaming()
+{
+   if (streaming->hooked)
+   {
+      evhtp_connection_set_hook(streaming->conn, evhtp_hook_on_write, nullptr, nullptr);
+      bufferevent_setwatermark(evhtp_connection_get_bev(streaming->conn), EV_WRITE, 0, 0);
+   }
+
+   streaming.reset();
+}
+
+//***************************************************************************
+// sendFile (sent file region w/o copying)
+//***************************************************************************
+
+int Response::sendFile(int fd, off_t offset, size_t len, int status)
+{
+   if (state == stDone)
+   {
+      close(fd);
+      return done;
+   }
+
+   auto* buffer= req->buffer_out;
+   evhtp_connection_t* conn= evhtp_request_get_connection(req);
+
+   if (fd < 0 || !buffer || !conn)
+   {
+      if (fd >= 0)
+         close(fd);
+
+      return fail;
+   }
+
+   if (!len)
+   {
+      close(fd);
+      return end(status);
+   }
+
+   // the segment owns the fd and closes it once the last reference (the output buffer) is gone
+
+   evbuffer_file_segment* segment= evbuffer_file_segment_new(fd, offset, len, EVBUF_FS_CLOSE_ON_FREE);
+
+   if (!segment)
+   {
+      close(fd);
+      return fail;
+   }
+
+   char contentLength[32];
+   snprintf(contentLength, sizeof(contentLength), "%zu", len);
+   set("Content-Length", contentLength);
+
+   evhtp_send_reply_start(req, status);
+
+   // plain connections: the segment goes directly to the socket's output buffer, which drains
+   // to the fd, so libevent sends it with sendfile. segments added to any other buffer are
+   // mapped (or read) into memory, which is still needed for TLS connections (encrypted)
+
+   if (req->method != htp_method_HEAD)
+   {
+      if (conn->bev && !conn->ssl)
+         evbuffer_add_file_segment(bufferevent_get_output(conn->bev), segment, 0, len);
+      else if (!evbuffer_add_file_segment(buffer, segment, 0, len))
+         evhtp_send_reply_body(req, buffer);
+   }
+
+   evbuffer_file_segment_free(segment);
+   evhtp_send_reply_end(req);
+
+   state= stDone;
+   return done;
+}
+
 //***************************************************************************
 } // namespace cex
 
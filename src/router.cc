@@ -0,0 +1,537 @@
+//*************************************************************************
+// File router.cc
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// cex Library Router class implementation
+//*************************************************************************
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include <cex/core.hpp>
+#include <cex/util.hpp>
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <unordered_map>
+
+namespace cex
+{
+
+//***************************************************************************
+// route cache (one per thread)
+//***************************************************************************
+
+static const size_t maxCachedPath= 1024;
+
+struct RouteCache
+{
+   typedef std::list<std::pair<std::string, std::vector<size_t>>> Entries;
+
+   RouteCache() : owner(0), generation(0) {}
+
+   unsigned long long owner;
+   unsigned long long generation;
+   Entries entries;                                              // most recently used first
+   std::unordered_map<std::string, Entries::iterator> index;
+   std::string key;
+};
+
+static thread_local RouteCache routeCache;
+static std::atomic<unsigned long long> routerInstances(0);
+
+//***************************************************************************
+// class Router
+//***************************************************************************
+// ctor
+//***************************************************************************
+
+Router::Router()
+   : cacheSize(0), instance(++routerInstances), generation(0), cacheHits(0), cacheMisses(0)
+{
+}
+
+//***************************************************************************
+// add
+//***************************************************************************
+
+void Router::add(Middleware* mw)
+{
+   size_t index= entries.size();
+
+   entries.push_back(mw);
+   generation++;
+
+   if (mw->method < 0)
+   {
+      any.add(mw, index);
+      return;
+   }
+
+   if ((size_t)mw->method >= methods.size())
+      methods.resize(mw->method + 1);
+
+   if (!methods[mw->method])
+      methods[mw->method].reset(new Table);
+
+   methods[mw->method]->add(mw, index);
+}
+
+//***************************************************************************
+// clear
+//***************************************************************************
+
+void Router::clear()
+{
+   generation++;
+   entries.clear();
+   methods.clear();
+
+   any.root.children.clear();
+   any.root.exact.clear();
+   any.root.contain.clear();
+   any.root.pattern.clear();
+   any.always.clear();
+   any.evaluate.clear();
+   any.regexes.clear();
+   any.regexesCompiled= true;
+
+   memset(any.startsKey, 0, sizeof(any.startsKey));
+}
+
+//***************************************************************************
+// resolve
+//***************************************************************************
+
+void Router::resolve(Request* req, std::vector<Middleware*>& chain) const
+{
+   StringView url= req->url();
+
+   chain.clear();
+
+   if (!cacheSize || url.size() > maxCachedPath)
+   {
+      std::vector<size_t> candidates;
+
+      lookup(req, candidates);
+
+      for (size_t index : candidates)
+         chain.push_back(entries[index]);
+
+      return;
+   }
+
+   RouteCache& cache= routeCache;
+   unsigned long long current= generation.load();
+
+   if (cache.owner != instance || cache.generation != current)
+   {
+      cache.entries.clear();
+      cache.index.clear();
+      cache.owner= instance;
+      cache.generation= current;
+   }
+
+   // key: method + path
+
+   cache.key.assign(1, (char)req->evhtp_method);
+   cache.key.append(url.data(), url.size());
+
+   auto it= cache.index.find(cache.key);
+
+   if (it != cache.index.end())
+   {
+      cacheHits.fetch_add(1, std::memory_order_relaxed);
+      cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+   }
+   else
+   {
+      cacheMisses.fetch_add(1, std::memory_order_relaxed);
+
+      if (cache.entries.size() >= cacheSize)
+      {
+         cache.index.erase(cache.entries.back().first);
+         cache.entries.pop_back();
+      }
+
+      cache.entries.emplace_front(cache.key, std::vector<size_t>());
+      lookup(req, cache.entries.front().second);
+      it= cache.index.insert(std::make_pair(cache.key, cache.entries.begin())).first;
+   }
+
+   for (size_t index : it->second->second)
+      chain.push_back(entries[index]);
+}
+
+//***************************************************************************
+// lookup (registration indices of all matching middlewares, ordered)
+//***************************************************************************
+
+void Router::lookup(Request* req, std::vector<size_t>& candidates) const
+{
+   int method= req->evhtp_method;
+
+   any.collect(req, entries, candidates);
+
+   if (method >= 0 && (size_t)method < methods.size() && methods[method])
+      methods[method]->collect(req, entries, candidates);
+
+   // restore registration order. contain-keys occurring more than once in the URL
+   // (and regexes matching at several positions) produce duplicates, drop them
+
+   std::sort(candidates.begin(), candidates.end());
+   candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+}
+
+//***************************************************************************
+// cache stats
+//***************************************************************************
+
+Router::CacheStats Router::getCacheStats() const
+{
+   CacheStats stats;
+
+   stats.hits= cacheHits.load();
+   stats.misses= cacheMisses.load();
+
+   return stats;
+}
+
+//***************************************************************************
+// class Router::Table
+//***************************************************************************
+// ctor
+//***************************************************************************
+
+Router::Table::Table()
+   : regexesCompiled(true)
+{
+   memset(startsKey, 0, sizeof(startsKey));
+}
+
+//***************************************************************************
+// add
+//***************************************************************************
+
+void Router::Table::add(Middleware* mw, size_t index)
+{
+   // same precedence as in Middleware::match: compare, contain, pattern, regex
+
+   if (!(mw->flags & Middleware::fMatching) || ((mw->flags & Middleware::fMatchContain) && mw->path.empty() && !(mw->flags & Middleware::fMatchCompare)))
+      always.push_back(index);
+   else if (mw->flags & Middleware::fMatchCompare)
+      insert(mw->path)->exact.push_back(index);
+   else if (mw->flags & Middleware::fMatchContain)
+   {
+      insert(mw->path)->contain.push_back(index);
+      startsKey[(unsigned char)mw->path[0]]= true;
+   }
+   else if (mw->flags & Middleware::fMatchPattern)
+      insert(mw->pattern.prefix())->pattern.push_back(index);
+   else if (regexes.add(mw->path, index))
+      regexesCompiled= false;
+   else
+      evaluate.push_back(index);
+}
+
+//***************************************************************************
+// collect all candidates of the table (unordered, may contain duplicates)
+//***************************************************************************
+
+void Router::Table::collect(Request* req, const std::vector<Middleware*>& entries, std::vector<size_t>& candidates) const
+{
+   const char* url= req->getUrl();
+
+   candidates.insert(candidates.end(), always.begin(), always.end());
+
+   collectExact(url, candidates);
+   collectContain(url, candidates);
+   collectPattern(url, entries, candidates);
+   collectRegex(url, candidates);
+
+   for (size_t index : evaluate)
+   {
+      if (entries[index]->match(req))
+         candidates.push_back(index);
+   }
+}
+
+//***************************************************************************
+// collect exact (fMatchCompare) candidates: single descent along the URL
+//***************************************************************************
+
+void Router::Table::collectExact(const char* url, std::vector<size_t>& candidates) const
+{
+   const Node* node= &root;
+   const char* p= url;
+
+   while (*p)
+   {
+      node= node->child(*p);
+
+      if (!node || strncmp(p, node->label.c_str(), node->label.size()))
+         return;
+
+      p += node->label.size();
+   }
+
+   candidates.insert(candidates.end(), node->exact.begin(), node->exact.end());
+}
+
+//***************************************************************************
+// collect contain (fMatchContain) candidates: descent from each possible start
+//***************************************************************************
+
+void Router::Table::collectContain(const char* url, std::vector<size_t>& candidates) const
+{
+   for (const char* start= url; *start; start++)
+   {
+      if (!startsKey[(unsigned char)*start])
+         continue;
+
+      const Node* node= &root;
+      const char* p= start;
+
+      while (*p && (node= node->child(*p)))
+      {
+         if (strncmp(p, node->label.c_str(), node->label.size()))
+            break;
+
+         // every node passed completely is a key contained in the URL
+
+         candidates.insert(candidates.end(), node->contain.begin(), node->contain.end());
+         p += node->label.size();
+      }
+   }
+}
+
+//***************************************************************************
+// collect pattern (fMatchPattern) candidates: literal prefix lookup + verification
+//***************************************************************************
+
+void Router::Table::collectPattern(const char* url, const std::vector<Middleware*>& entries, std::vector<size_t>& candidates) const
+{
+   const Node* node= &root;
+   const char* p= url;
+
+   while (node)
+   {
+      for (size_t index : node->pattern)
+      {
+         if (entries[index]->pattern.match(url, nullptr))
+            candidates.push_back(index);
+      }
+
+      if (!*p || !(node= node->child(*p)) || strncmp(p, node->label.c_str(), node->label.size()))
+         break;
+
+      p += node->label.size();
+   }
+}
+
+//***************************************************************************
+// collect regex (fMatchRegex) candidates: single pass of the combined automaton
+//***************************************************************************
+
+void Router::Table::collectRegex(const char* url, std::vector<size_t>& candidates) const
+{
+   if (!regexesCompiled.load(std::memory_order_acquire))
+   {
+      std::lock_guard<std::mutex> lock(regexMutex);
+
+      if (!regexesCompiled.load(std::memory_order_relaxed))
+      {
+         regexes.compile();
+         regexesCompiled.store(true, std::memory_order_release);
+      }
+   }
+
+   regexes.match(url, candidates);
+}
+
+//***************************************************************************
+// insert key into the radix tree, splitting edges where necessary
+//***************************************************************************
+
+Router::Node* Router::Table::insert(const std::string& key)
+{
+   Node* node= &root;
+   size_t pos= 0;
+
+   while (pos < key.size())
+   {
+      Node* next= node->child(key[pos]);
+
+      if (!next)
+      {
+         std::unique_ptr<Node> leaf(new Node);
+         leaf->label= key.substr(pos);
+         node->children.push_back(std::move(leaf));
+
+         return node->children.back().get();
+      }
+
+      // length of common prefix of edge label and remaining key
+
+      size_t common= 0;
+
+      while (common < next->label.size() && pos + common < key.size() && next->label[common] == key[pos + common])
+         common++;
+
+      if (common < next->label.size())
+      {
+         // split edge: next becomes child of a new node holding the common part
+
+         std::unique_ptr<Node> split(new Node);
+         split->label= next->label.substr(0, common);
+
+         for (auto& c : node->children)
+         {
+            if (c.get() == next)
+            {
+               next->label.erase(0, common);
+               split->children.push_back(std::move(c));
+               c= std::move(split);
+               next= c.get();
+               break;
+            }
+         }
+      }
+
+      node= next;
+      pos += common;
+   }
+
+   return node;
+}
+
+//***************************************************************************
+// class PathPattern
+//***************************************************************************
+// ctor (compile pattern into segments)
+//***************************************************************************
+
+PathPattern::PathPattern(const std::string& pattern)
+{
+   size_t pos= 0;
+
+   while (pos < pattern.size())
+   {
+      Segment seg;
+      bool segmentStart= !pos || pattern[pos-1] == '/';
+
+      if (segmentStart && pattern[pos] == '*')
+      {
+         // wildcard always takes the rest of the pattern
+
+         seg.type= sgWildcard;
+         seg.text= pattern.substr(pos+1);
+         pos= pattern.size();
+      }
+      else if (segmentStart && pattern[pos] == ':')
+      {
+         size_t end= pattern.find('/', pos);
+
+         if (end == std::string::npos)
+            end= pattern.size();
+
+         seg.type= sgParam;
+         seg.text= pattern.substr(pos+1, end-pos-1);
+         pos= end;
+      }
+      else
+      {
+         // literal text up to the next segment starting with a parameter/wildcard
+
+         size_t end= pos;
+
+         while (end < pattern.size() && !((pattern[end] == ':' || pattern[end] == '*') && end && pattern[end-1] == '/'))
+            end++;
+
+         seg.type= sgLiteral;
+         seg.text= pattern.substr(pos, end-pos);
+         pos= end;
+      }
+
+      segments.push_back(std::move(seg));
+   }
+
+   if (!segments.empty() && segments[0].type == sgLiteral)
+      literalPrefix= segments[0].text;
+}
+
+//***************************************************************************
+// match
+//***************************************************************************
+
+bool PathPattern::match(const char* path, RouteParams* params) const
+{
+   const char* p= path;
+
+   if (params)
+      params->clear();
+
+   for (const auto& seg : segments)
+   {
+      switch (seg.type)
+      {
+         case sgLiteral:
+         {
+            if (strncmp(p, seg.text.c_str(), seg.text.size()))
+               return false;
+
+            p += seg.text.size();
+            break;
+         }
+
+         case sgParam:
+         {
+            const char* start= p;
+
+            while (*p && *p != '/')
+               p++;
+
+            if (p == start)
+               return false;
+
+            if (params)
+               params->emplace_back(StringView(seg.text), StringView(start, p-start));
+
+            break;
+         }
+
+         case sgWildcard:
+         {
+            size_t len= strlen(p);
+
+            if (params)
+               params->emplace_back(StringView(seg.text), StringView(p, len));
+
+            p += len;
+            break;
+         }
+      }
+   }
+
+   return !*p;
+}
+
+//***************************************************************************
+// class Router::Node
+//***************************************************************************
+
+Router::Node* Router::Node::child(char c) const
+{
+   for (const auto& n : children)
+   {
+      if (n->label[0] == c)
+         return n.get();
+   }
+
+   return nullptr;
+}
+
+//***************************************************************************
+} // namespace cex
@@ -17,7 +17,7 @@ namespace cex
 {
 
 //***************************************************************************
-// Middleware securityHeaders
+// struct SecurityOptions
 //***************************************************************************
 
 static struct SecurityOptions defaultOptions;
@@ -38,134 +38,149 @@ SecurityOptions::SecurityOptions()
    hpkpIncludeSubDomains= true;
 }
 
-MiddlewareFunction securityHeaders(const std::shared_ptr<SecurityOptions>& opts)
+//***************************************************************************
+// build the headers (once per middleware)
+//***************************************************************************
+
+static void buildHeaders(const SecurityOptions* theOpts, HeaderBlock& block)
 {
-   // opts is CAPTURED, thus held for the lifetime of the lambda. this is INTENDED, and NOT a leak,
-   // so the shared_ptr is not an issue
+   // X-DNS-Prefetch-Control
 
-   MiddlewareFunction res = [opts](Request* req, Response* res, const std::function<void()>& next)
+   if (theOpts->noDNSPrefetch != na)
+      block.add("X-DNS-Prefetch-Control", theOpts->noDNSPrefetch ? "off" : "on");
+
+   // X-Frame-Options
+
+   if (theOpts->xFrameAllow != xfUnknown)
    {
-      SecurityOptions* theOpts = opts.get() ? opts.get() : &defaultOptions;
+      if (theOpts->xFrameAllow == xfFrom)
+      {
+         std::string from("ALLOW-FROM " + theOpts->xFrameFrom);
+         block.add("X-Frame-Options", from);
+      }
+      else
+      {
+         block.add("X-Frame-Options", theOpts->xFrameAllow == xfDeny ? "DENY" : "SAMEORIGIN");
+      }
+   }
 
-      // X-DNS-Prefetch-Control
+   // Public-Key-Pins
 
-      if (theOpts->noDNSPrefetch != na)
-         res->set("X-DNS-Prefetch-Control", theOpts->noDNSPrefetch ? "off" : "on");
+   if (theOpts->hpkpMaxAge > 0 && !theOpts->hpkpKeys.empty())
+   {
+      std::string pin;
+      auto it= theOpts->hpkpKeys.begin();
+      char age[100];
 
-      // X-Frame-Options
+      sprintf(age, "%d", theOpts->hpkpMaxAge);
 
-      if (theOpts->xFrameAllow != xfUnknown)
+      while (it != theOpts->hpkpKeys.end())
       {
-         if (theOpts->xFrameAllow == xfFrom)
-         {
-            std::string from("ALLOW-FROM " + theOpts->xFrameFrom);
-            res->set("X-Frame-Options", from.c_str());
-         }
-         else
-         {
-            res->set("X-Frame-Options", theOpts->xFrameAllow == xfDeny ? "DENY" : "SAMEORIGIN");
-         }
+         if (it != theOpts->hpkpKeys.begin())
+            pin += "; ";
+
+         pin += "pin-sha256=\"";
+         pin += *it;
+         pin += "\"";
+
+         it++;
       }
 
-      // Public-Key-Pins
+      pin += "; max-age=";
+      pin += age;
 
-      if (theOpts->hpkpMaxAge > 0 && !theOpts->hpkpKeys.empty())
+      if (theOpts->hpkpIncludeSubDomains)
+         pin += "; includeSubdomains";
+         
+      if (theOpts->hpkpReportUri.length())
       {
-         std::string pin;
-         auto it= theOpts->hpkpKeys.begin();
-         char age[100];
-
-         sprintf(age, "%d", theOpts->hpkpMaxAge);
-
-         while (it != theOpts->hpkpKeys.end())
-         {
-            if (it != theOpts->hpkpKeys.begin())
-               pin += "; ";
-
-            pin += "pin-sha256=\"";
-            pin += *it;
-            pin += "\"";
-
-            it++;
-         }
-
-         pin += "; max-age=";
-         pin += age;
-
-         if (theOpts->hpkpIncludeSubDomains)
-            pin += "; includeSubdomains";
-            
-         if (theOpts->hpkpReportUri.length())
-         {
-            pin += "; report-uri=\"";
-            pin += theOpts->hpkpReportUri;
-            pin += "\"";
-         }
-
-         res->set("Public-Key-Pins", pin.c_str());
+         pin += "; report-uri=\"";
+         pin += theOpts->hpkpReportUri;
+         pin += "\"";
       }
 
-      // Strict-Transport-Security
+      block.add("Public-Key-Pins", pin);
+   }
 
-      if (theOpts->stsMaxAge > 0)
-      {
-         std::string sts("max-age=");
-         char age[100];
+   // Strict-Transport-Security
 
-         sprintf(age, "%d", theOpts->stsMaxAge);
-         sts += age;
+   if (theOpts->stsMaxAge > 0)
+   {
+      std::string sts("max-age=");
+      char age[100];
 
-         if (theOpts->stsIncludeSubDomains)
-            sts += "; includeSubdomains";
-         
-         if (theOpts->stsPreload)
-            sts += "; preload";
+      sprintf(age, "%d", theOpts->stsMaxAge);
+      sts += age;
 
-         res->set("Strict-Transport-Security", sts.c_str());
-      }
+      if (theOpts->stsIncludeSubDomains)
+         sts += "; includeSubdomains";
+      
+      if (theOpts->stsPreload)
+         sts += "; preload";
 
-      // X-Download-Options
+      block.add("Strict-Transport-Security", sts);
+   }
 
-      if (theOpts->ieNoOpen)
-         res->set("X-Download-Options", "noopen");
+   // X-Download-Options
 
-      // some anti-caching headers
+   if (theOpts->ieNoOpen)
+      block.add("X-Download-Options", "noopen");
 
-      if (theOpts->disableCache)
-      {
-         res->set("Cache-Control", "no-store, no-cache, must-revalidate, proxy-revalidate");
-         res->set("Pragma", "no-cache");
-         res->set("Expires", "0");
-      }
+   // some anti-caching headers
+
+   if (theOpts->disableCache)
+   {
+      block.add("Cache-Control", "no-store, no-cache, must-revalidate, proxy-revalidate");
+      block.add("Pragma", "no-cache");
+      block.add("Expires", "0");
+   }
 
-      // X-Content-Type-Options
+   // X-Content-Type-Options
 
-      if (theOpts->noSniff)
-         res->set("X-Content-Type-Options", "nosniff");
+   if (theOpts->noSniff)
+      block.add("X-Content-Type-Options", "nosniff");
 
-      // Referrer-Policy
+   // Referrer-Policy
 
-      if (theOpts->referrer != na)
+   if (theOpts->referrer != na)
+   {
+      switch (theOpts->referrer)
       {
-         switch (theOpts->referrer)
-         {
-            case refNoReferrer:                  res->set("Referrer-Policy", "no-referrer"); break;
-            case refNoReferrerWhenDowngrade:     res->set("Referrer-Policy", "no-referrer-when-downgrade"); break;
-            case refSameOrigin:                  res->set("Referrer-Policy", "same-origin"); break;
-            case refOrigin:                      res->set("Referrer-Policy", "origin"); break;
-            case refStrictOrigin:                res->set("Referrer-Policy", "strict-origin"); break;
-            case refOriginWhenCrossOrigin:       res->set("Referrer-Policy", "origin-when-cross-origin"); break;
-            case refStrictOriginWhenCrossOrigin: res->set("Referrer-Policy", "strict-origin-when-cross-origin"); break;
-            case refUnsafeUrl:                   res->set("Referrer-Policy", "unsafe-url"); break;
-            default:
-               break;
-         }
+         case refNoReferrer:                  block.add("Referrer-Policy", "no-referrer"); break;
+         case refNoReferrerWhenDowngrade:     block.add("Referrer-Policy", "no-referrer-when-downgrade"); break;
+         case refSameOrigin:                  block.add("Referrer-Policy", "same-origin"); break;
+         case refOrigin:                      block.add("Referrer-Policy", "origin"); break;
+         case refStrictOrigin:                block.add("Referrer-Policy", "strict-origin"); break;
+         case refOriginWhenCrossOrigin:       block.add("Referrer-Policy", "origin-when-cross-origin"); break;
+         case refStrictOriginWhenCrossOrigin: block.add("Referrer-Policy", "strict-origin-when-cross-origin"); break;
+         case refUnsafeUrl:                   block.add("Referrer-Policy", "unsafe-url"); break;
+         default:
+            break;
       }
+   }
+
+   // X-XSS-Protection
+
+   if (theOpts->xssProtection)
+      block.add("X-XSS-Protection", "1; mode=block");
+}
 
-      // X-XSS-Protection
+//***************************************************************************
+// Middleware securityHeaders
+//***************************************************************************
 
-      if (theOpts->xssProtection)
-         res->set("X-XSS-Protection", "1; mode=block");
+MiddlewareFunction securityHeaders(const std::shared_ptr<SecurityOptions>& opts)
+{
+   // the headers only depend on the options, thus they are built once and
+   // attached to each response without copying
+
+   std::shared_ptr<HeaderBlock> block= std::make_shared<HeaderBlock>();
+
+   buildHeaders(opts.get() ? opts.get() : &defaultOptions, *block);
+
+   MiddlewareFunction res = [block](Request* req, Response* res, const std::function<void()>& next)
+   {
+      res->set(*block);
 
       next();
    };
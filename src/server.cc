@@ -13,6 +13,7 @@
 #include <cex/core.hpp>
 #include <cex/ssl.hpp>
 #include <cex/util.hpp>
+#include <algorithm>
 #include <utility>
 #include <cstring>
 #ifdef EVHTP_WS_SUPPORT
@@ -35,6 +36,7 @@ namespace cex
 
 bool Server::initialized= false;
 std::mutex Server::initMutex;
+std::atomic<unsigned long long> Server::instances(0);
 std::unique_ptr<MimeTypes> Server::mimeTypes(new MimeTypes);
 
 const char* getLibraryVersion()
@@ -47,7 +49,7 @@ const char* getLibraryVersion()
 //***************************************************************************
 
 Server::Server(Config& config)
-   : serverConfig(config)
+   : routesVersion(0), routesDirty(true), routesLive(false), instance(++instances), serverConfig(config)
 {
    libraryInit();
 
@@ -55,6 +57,7 @@ Server::Server(Config& config)
 }
 
 Server::Server() 
+   : routesVersion(0), routesDirty(true), routesLive(false), instance(++instances)
 { 
    libraryInit();
    startSignaled= started= false;
@@ -176,6 +179,17 @@ int Server::start(bool block)
       }
 #endif
 
+      // from now on, route changes are published right away (see routesChanged)
+
+      {
+         std::lock_guard<std::mutex> lock(routesMutex);
+
+         routesLive= true;
+
+         if (routesDirty)
+            publishRoutes();
+      }
+
       auto cb= evhtp_set_cb(httpServer.get(), "", Server::handleRequest, this);
       evhtp_callback_set_hook(cb, evhtp_hook_on_headers, (evhtp_hook)Server::handleHeaders, this);
 
@@ -274,7 +288,131 @@ void Server::use(const MiddlewareFunction& func)
 
 void Server::use(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, na, flags));
+   attach(path, func, na, flags);
+}
+
+//***************************************************************************
+// attach (register middleware with router)
+//***************************************************************************
+
+void Server::attach(const char* path, const MiddlewareFunction& func, int method, int flags)
+{
+   std::lock_guard<std::mutex> lock(routesMutex);
+
+   middleWares.emplace_back(new Middleware(path, func, method, flags));
+
+   if (serverConfig.collectMiddlewareStats)
+      middleWares.back()->enableStats();
+
+   routesChanged();
+}
+
+//***************************************************************************
+// middleware statistics
+//***************************************************************************
+
+std::vector<MiddlewareStats> Server::middlewareStats()
+{
+   std::lock_guard<std::mutex> lock(routesMutex);
+   std::vector<MiddlewareStats> result(middleWares.size());
+
+   for (size_t i= 0; i < middleWares.size(); i++)
+   {
+      middleWares[i]->getStats(result[i]);
+      result[i].index= i;
+   }
+
+   return result;
+}
+
+//***************************************************************************
+// reset
+//***************************************************************************
+
+void Server::reset()
+{
+   std::lock_guard<std::mutex> lock(routesMutex);
+
+   middleWares.clear();
+   routesChanged();
+}
+
+//***************************************************************************
+// get routes (current snapshot)
+//***************************************************************************
+
+Server::RoutesPtr Server::getRoutes()
+{
+   // each thread keeps the snapshot it has seen last. as long as the routes did not change,
+   // this costs a single atomic load. after a change, each thread fetches the snapshot
+   // (already built by the registering call) once under the lock
+
+   struct Cached
+   {
+      Cached() : instance(0), version(0) {}
+
+      unsigned long long instance;
+      unsigned long long version;
+      RoutesPtr routes;
+   };
+
+   static thread_local Cached cached;
+
+   unsigned long long version= routesVersion.load(std::memory_order_acquire);
+
+   if (cached.instance == instance && cached.version == version && cached.routes)
+      return cached.routes;
+
+   std::lock_guard<std::mutex> lock(routesMutex);
+
+   // routes changed before the server was started are published here (or by start)
+
+   if (routesDirty)
+      publishRoutes();
+
+   cached.instance= instance;
+   cached.version= routesVersion.load(std::memory_order_relaxed);
+   cached.routes= published;
+
+   return published;
+}
+
+//***************************************************************************
+// routes changed (called with routesMutex held)
+//***************************************************************************
+
+void Server::routesChanged()
+{
+   // until the server is started, changes are collected and published at once, so
+   // registering many routes stays linear. afterwards, each change is published right away
+
+   routesDirty= true;
+
+   if (routesLive)
+      publishRoutes();
+}
+
+//***************************************************************************
+// publish routes (new snapshot, called with routesMutex held)
+//***************************************************************************
+
+void Server::publishRoutes()
+{
+   // the previous snapshot is released by the last request (or thread) using it
+
+   std::shared_ptr<Routes> routes(new Routes);
+
+   routes->middleWares= middleWares;
+   routes->uploadWares= uploadWares;
+   routes->limitWares= limitWares;
+   routes->router.setCacheSize(serverConfig.routeCacheSize);
+
+   for (const auto& mw : routes->middleWares)
+      routes->router.add(mw.get());
+
+   published= routes;
+   routesDirty= false;
+   routesVersion.fetch_add(1, std::memory_order_release);
 }
 
 //***************************************************************************
@@ -288,7 +426,7 @@ void Server::get(const MiddlewareFunction& func)
 
 void Server::get(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_GET, flags));
+   attach(path, func, htp_method_GET, flags);
 }
 
 void Server::put(const MiddlewareFunction& func)
@@ -298,7 +436,7 @@ void Server::put(const MiddlewareFunction& func)
 
 void Server::put(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_PUT, flags));
+   attach(path, func, htp_method_PUT, flags);
 }
 
 void Server::post(const MiddlewareFunction& func)
@@ -308,7 +446,7 @@ void Server::post(const MiddlewareFunction& func)
 
 void Server::post(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_POST, flags));
+   attach(path, func, htp_method_POST, flags);
 }
 
 void Server::head(const MiddlewareFunction& func)
@@ -318,7 +456,7 @@ void Server::head(const MiddlewareFunction& func)
 
 void Server::head(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_HEAD, flags));
+   attach(path, func, htp_method_HEAD, flags);
 }
 
 void Server::del(const MiddlewareFunction& func)
@@ -328,7 +466,7 @@ void Server::del(const MiddlewareFunction& func)
 
 void Server::del(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_DELETE, flags));
+   attach(path, func, htp_method_DELETE, flags);
 }
 
 void Server::connect(const MiddlewareFunction& func)
@@ -338,7 +476,7 @@ void Server::connect(const MiddlewareFunction& func)
 
 void Server::connect(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_CONNECT, flags));
+   attach(path, func, htp_method_CONNECT, flags);
 }
 
 void Server::options(const MiddlewareFunction& func)
@@ -348,7 +486,7 @@ void Server::options(const MiddlewareFunction& func)
 
 void Server::options(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_OPTIONS, flags));
+   attach(path, func, htp_method_OPTIONS, flags);
 }
 
 void Server::trace(const MiddlewareFunction& func)
@@ -358,7 +496,7 @@ void Server::trace(const MiddlewareFunction& func)
 
 void Server::trace(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_TRACE, flags));
+   attach(path, func, htp_method_TRACE, flags);
 }
 
 void Server::patch(const MiddlewareFunction& func)
@@ -368,7 +506,7 @@ void Server::patch(const MiddlewareFunction& func)
 
 void Server::patch(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_PATCH, flags));
+   attach(path, func, htp_method_PATCH, flags);
 }
 
 void Server::mkcol(const MiddlewareFunction& func)
@@ -378,7 +516,7 @@ void Server::mkcol(const MiddlewareFunction& func)
 
 void Server::mkcol(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_MKCOL, flags));
+   attach(path, func, htp_method_MKCOL, flags);
 }
 
 void Server::copy(const MiddlewareFunction& func)
@@ -388,7 +526,7 @@ void Server::copy(const MiddlewareFunction& func)
 
 void Server::copy(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_COPY, flags));
+   attach(path, func, htp_method_COPY, flags);
 }
 
 void Server::move(const MiddlewareFunction& func)
@@ -398,7 +536,7 @@ void Server::move(const MiddlewareFunction& func)
 
 void Server::move(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_MOVE, flags));
+   attach(path, func, htp_method_MOVE, flags);
 }
 
 void Server::propfind(const MiddlewareFunction& func)
@@ -408,7 +546,7 @@ void Server::propfind(const MiddlewareFunction& func)
 
 void Server::propfind(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_PROPFIND, flags));
+   attach(path, func, htp_method_PROPFIND, flags);
 }
 
 void Server::proppatch(const MiddlewareFunction& func)
@@ -418,7 +556,7 @@ void Server::proppatch(const MiddlewareFunction& func)
 
 void Server::proppatch(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_PROPPATCH, flags));
+   attach(path, func, htp_method_PROPPATCH, flags);
 }
 
 void Server::lock(const MiddlewareFunction& func)
@@ -428,7 +566,7 @@ void Server::lock(const MiddlewareFunction& func)
 
 void Server::lock(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_LOCK, flags));
+   attach(path, func, htp_method_LOCK, flags);
 }
 
 void Server::unlock(const MiddlewareFunction& func)
@@ -438,7 +576,7 @@ void Server::unlock(const MiddlewareFunction& func)
 
 void Server::unlock(const char* path, const MiddlewareFunction& func, int flags)
 {
-   middleWares.emplace_back(new Middleware(path, func, htp_method_UNLOCK, flags));
+   attach(path, func, htp_method_UNLOCK, flags);
 }
 
 // upload hooks to catch file uploads w/ streaming
@@ -474,7 +612,24 @@ void Server::uploads(const char* path, const UploadFunction& func, Method method
          break;
    }
 
+   std::lock_guard<std::mutex> lock(routesMutex);
+
    uploadWares.emplace_back(new Middleware(path, func, m, flags));
+   routesChanged();
+}
+
+// request body limits per route
+
+void Server::maxBodySize(const char* path, size_t size, int flags)
+{
+   std::shared_ptr<Middleware> mw(new Middleware(path, MiddlewareFunction(), na, flags));
+
+   mw->maxBodySize= size;
+
+   std::lock_guard<std::mutex> lock(routesMutex);
+
+   limitWares.push_back(mw);
+   routesChanged();
 }
 
 #ifdef EVHTP_WS_SUPPORT
@@ -569,12 +724,60 @@ evhtp_res Server::handleHeaders(evhtp_request_t* request, evhtp_headers_t* hdr,
    // holds the request, response and server pointers.
 
    auto serv= reinterpret_cast<Server*>(arg);
-   auto ctx= new Server::Context(request, serv);
+   Arena* arena= Arena::acquire();
+   auto ctx= arena->create<Server::Context>(request, serv, arena);
+
+   ctx->res.get()->setStreamWatermark(serv->serverConfig.streamWatermark);
+
+   // resolve the upload middleware once, body chunks are then passed on directly
+
+   for (const auto& mw : ctx->routes->uploadWares)
+   {
+      if (mw->match(ctx->req.get()))
+      {
+         ctx->upload= mw.get();
+         ctx->upload->bind(ctx->req.get());
+         break;
+      }
+   }
+
+   // body size limit (first matching route, or global)
+
+   ctx->maxBodySize= serv->serverConfig.maxBodySize;
+
+   for (const auto& mw : ctx->routes->limitWares)
+   {
+      if (mw->match(ctx->req.get()))
+      {
+         ctx->maxBodySize= mw->maxBodySize;
+         break;
+      }
+   }
+
+   bool zeroCopy= serv->serverConfig.zeroCopyBody && !ctx->upload;
+
+   if (zeroCopy)
+      ctx->req->bodyBuffer= request->buffer_in;
+
+   // an announced oversized body is discarded while being received (never buffered) and answered
+   // with 413 in handleRequest. otherwise reserve the body once (bounded, the Content-Length is
+   // not trusted beyond MAX_BODY_RESERVE)
+
+   const char* contentLength= ctx->req->get(hdr::ContentLength);
+   size_t announced= contentLength ? strtoull(contentLength, nullptr, 10) : 0;
+
+   if (ctx->maxBodySize && announced > ctx->maxBodySize)
+      ctx->bodyTooLarge= true;
+   else if (announced && !zeroCopy && !ctx->upload)
+      ctx->req->body.reserve(std::min(announced, (size_t)MAX_BODY_RESERVE));
 
    // add hooks for body upload & finish of request. 'handleRequest' was already registered
-   // in Server::listen
+   // in Server::listen. without a hook, libevhtp moves the body chunks into the request's
+   // input buffer, which is then used as the body (zero-copy)
+
+   if (!zeroCopy || ctx->maxBodySize)
+      evhtp_request_set_hook(request, evhtp_hook_on_read, (evhtp_hook)Server::handleBody, ctx); 
 
-   evhtp_request_set_hook(request, evhtp_hook_on_read, (evhtp_hook)Server::handleBody, ctx); 
    evhtp_request_set_hook(request, evhtp_hook_on_request_fini, (evhtp_hook)Server::handleFinished, ctx); 
 
    return EVHTP_RES_OK;
@@ -587,66 +790,74 @@ evhtp_res Server::handleHeaders(evhtp_request_t* request, evhtp_headers_t* hdr,
 evhtp_res Server::handleBody(evhtp_request_t* req, struct evbuffer* buf, void* arg)
 {
    auto ctx= reinterpret_cast<Server::Context*>(arg);
-   std::vector<char>* body= &(ctx->req->body);
+   auto body= &(ctx->req->body);
+   size_t bytesReady= evbuffer_get_length(buf);
 
-   if (!body)                 // should never happen
-      return EVHTP_RES_OK;
+   ctx->bodySize += bytesReady;
 
-   size_t bytesReady= evbuffer_get_length(buf);
-   size_t oldSize= body->size();
+   if (ctx->maxBodySize && ctx->bodySize > ctx->maxBodySize)
+      ctx->bodyTooLarge= true;
 
-   // (1) check if we have attached upload middleware(s)
+   // (1) body exceeds the limit (announced or while receiving): discard everything (answered with 413 in handleRequest)
 
-   if (!ctx->serv->uploadWares.empty())
+   if (ctx->bodyTooLarge)
    {
-      auto it= ctx->serv->uploadWares.begin();
+      evbuffer_drain(buf, bytesReady);
 
-      while (it != ctx->serv->uploadWares.end())
+      if (!body->empty())
       {
-         if (!((*it)->match(ctx->req.get())))
-         {
-            ++it;
-            continue;
-         }
+         body->clear();
+         body->shrink_to_fit();
+      }
 
-         // we found a matching upload ware. copy bytes into body buffer (CURRENT CHUNK ONLY)
-         // and call the upload middleware function.
+      if (ctx->req->bodyBuffer)
+         evbuffer_drain(ctx->req->bodyBuffer, evbuffer_get_length(ctx->req->bodyBuffer));
 
-         body->resize(bytesReady);
+      return EVHTP_RES_OK;
+   }
 
-         if (body->size() < bytesReady)
-         {
-            // allocation error
+   // (2) zero-copy body: leave the chunk, libevhtp moves it into the request's input buffer
 
-            return EVHTP_RES_500;
-         }
-
-         ev_ssize_t bytesCopied= evbuffer_copyout(buf, (void*)(body->data()), bytesReady);
+   if (ctx->req->bodyBuffer)
+      return EVHTP_RES_OK;
 
+   // (3) hand the chunk's segments to the upload middleware without copying, or append them
+   // to the (full) body buffer, which was reserved if the Content-Length is known
 
-         ctx->req->middlewarePath= (*it)->getPath();
-         (*it)->uploadFunc(ctx->req.get(), body->data(), bytesCopied);
+   evbuffer_iovec segments[16];
+   int count= evbuffer_peek(buf, -1, nullptr, segments, 16);
+   std::vector<evbuffer_iovec> more;
+   evbuffer_iovec* segment= segments;
 
-         return EVHTP_RES_OK;
-      }
+   if (count > 16)
+   {
+      more.resize(count);
+      evbuffer_peek(buf, -1, nullptr, more.data(), count);
+      segment= more.data();
    }
 
-   // (2) no upload middleware attached, or none matched. just copy bytes into (full) body buffer
-
-   body->resize(bytesReady + oldSize);
+   try
+   {
+      for (int i= 0; i < count; i++)
+      {
+         const char* data= (const char*)segment[i].iov_base;
 
-   if (body->size() < (bytesReady + oldSize))
+         if (ctx->upload)
+            ctx->upload->uploadFunc(ctx->req.get(), data, segment[i].iov_len);
+         else
+            body->insert(body->end(), data, data + segment[i].iov_len);
+      }
+   }
+   catch (const std::bad_alloc&)
    {
       // allocation error
 
       return EVHTP_RES_500;
    }
 
-   evbuffer_copyout(buf, (void*)(body->data() + oldSize), bytesReady);
-
    // drain, so libevhtp won't copy it into the native request's internal buffer (req->buffer_in)
 
-   evbuffer_drain(buf, evbuffer_get_length(buf));
+   evbuffer_drain(buf, bytesReady);
 
    return EVHTP_RES_OK;
 }
@@ -671,6 +882,16 @@ void Server::handleRequest(evhtp_request* req, void* arg)
       return;
    }
 
+   // the client may keep sending, so the connection is closed after the reply
+
+   if (ctx->bodyTooLarge)
+   {
+      evhtp_request_set_keepalive(req, 0);
+      ctx->res.get()->setStatic("Connection", "close");
+      ctx->res.get()->end(413);
+      return;
+   }
+
    // retrieve SSL client info (certificate), if available & configured
 
 #ifdef CEX_WITH_SSL
@@ -683,7 +904,7 @@ void Server::handleRequest(evhtp_request* req, void* arg)
 #ifdef CEX_WITH_ZLIB
    if (ctx->serv->serverConfig.compress)
    {
-      const char* acceptEncoding= ctx->req.get()->get("Accept-Encoding");
+      const char* acceptEncoding= ctx->req.get()->get(hdr::AcceptEncoding);
 
       if (acceptEncoding && strstr(acceptEncoding, "gzip"))
          ctx->res.get()->setFlags(ctx->res.get()->getFlags() | Response::fCompressGZip);
@@ -692,61 +913,123 @@ void Server::handleRequest(evhtp_request* req, void* arg)
    }
 #endif
 
-   // call all registered handlers (route-based and general middlewares)
+   // call all matching handlers (route-based and general middlewares), as resolved by the router
 
-   auto it= ctx->serv->middleWares.begin();
+   ctx->routes->router.resolve(ctx->req.get(), ctx->chain);
 
-   if (it == ctx->serv->middleWares.end())
+   if (ctx->chain.empty())
    {
-      ctx->res.get()->end(404);
+      // no middlewares attached, or none matched. the request will hang (thats intended)
+      // unless no middlewares are attached at all
+
+      if (ctx->routes->middleWares.empty())
+         ctx->res.get()->end(404);
+
       return;
    }
 
-   std::function<void()> next;
+   if (ctx->serv->serverConfig.collectMiddlewareStats)
+   {
+      for (auto mw : ctx->chain)
+         mw->countMatch();
+   }
 
-   // create next-function to be handed to each middleware
+   ctx->dispatcher.dispatch(0);
+}
 
-   next = [&next, &ctx, &it]()
+//***************************************************************************
+// handle finished (step 4)
+//***************************************************************************
+
+evhtp_res Server::handleFinished(evhtp_request_t* req, void* arg)
+{
+   // forget the request context we created. destroying it releases request & response,
+   // all their memory goes back with the arena in one go
+
+   auto ctx= reinterpret_cast<Server::Context*>(arg);
+   Arena* arena= ctx->arena;
+
+   // handles of suspended requests may outlive the context, they must not touch it anymore
+
+   if (ctx->async)
    {
-      ++it;
+      ctx->async->alive= false;
+      ctx->async->stopTimer();
+   }
 
-      if (it != ctx->serv->middleWares.end())
-      {
-         if ((*it)->match(ctx->req.get()))
-         {
-            ctx->req.get()->middlewarePath= (*it)->getPath();
-            (*it)->func(ctx->req.get(), ctx->res.get(), next);
-         }
-         else
-            next();
-      }
+   ctx->~Context();
+   Arena::release(arena);
+   
+   return EVHTP_RES_OK;
+}
+
+//***************************************************************************
+// class Server::Dispatcher
+//***************************************************************************
+// ctor
+//***************************************************************************
+
+Server::Dispatcher::Dispatcher(Context* ctx)
+   : ctx(ctx), cursor(0), timed(std::string::npos)
+{
+   // next() continues after the middleware currently running. calls after
+   // the end of the chain was reached are ignored
+
+   next= [this]()
+   {
+      if (cursor < this->ctx->chain.size())
+         dispatch(cursor + 1);
    };
+}
+
+//***************************************************************************
+// dispatch (call the first middleware with a function, starting at 'from')
+//***************************************************************************
+
+void Server::Dispatcher::dispatch(size_t from)
+{
+   // the calling middleware (if any) is done as soon as it calls next()
 
-   // call next handler OR next-function, if next handler doesn't match.
-   // if no middleware matched, the request will hang (thats intended).
+   finish();
 
-   if ((*it)->match(ctx->req.get()))
+   for (cursor= from; cursor < ctx->chain.size(); cursor++)
    {
-      ctx->req.get()->middlewarePath= (*it)->getPath();
-      (*it)->func(ctx->req.get(), ctx->res.get(), next);
+      Middleware* mw= ctx->chain[cursor];
+      size_t index= cursor;
+
+      if (!mw->func)
+         continue;
+
+      mw->bind(ctx->req.get());
+
+      if (mw->stats)
+      {
+         timed= index;
+         started= std::chrono::steady_clock::now();
+      }
+
+      mw->func(ctx->req.get(), ctx->res.get(), next);
+
+      if (timed == index)
+         finish();
+
+      return;
    }
-   else
-      next();
 }
 
 //***************************************************************************
-// handle finished (step 4)
+// finish (record the time of the currently timed middleware)
 //***************************************************************************
 
-evhtp_res Server::handleFinished(evhtp_request_t* req, void* arg)
+void Server::Dispatcher::finish()
 {
-   // forget the request context we created
+   if (timed == std::string::npos)
+      return;
 
-   auto ctx= reinterpret_cast<Server::Context*>(arg);
+   auto elapsed= std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
 
-   delete ctx;
-   
-   return EVHTP_RES_OK;
+   ctx->chain[timed]->countInvocation(elapsed.count());
+   timed= std::string::npos;
 }
 
 //***************************************************************************
@@ -762,6 +1045,11 @@ Server::Config::Config()
    parseSslInfo= true; 
    sslEnabled= false;
    threadCount= 4; 
+   collectMiddlewareStats= false;
+   routeCacheSize= 0;
+   zeroCopyBody= false;
+   maxBodySize= 0;
+   streamWatermark= STREAM_WATERMARK;
 
 #ifdef CEX_WITH_SSL
    sslVerifyMode= 0;
@@ -780,6 +1068,11 @@ Server::Config::Config(Config& other)
    parseSslInfo= other.parseSslInfo;
    sslEnabled= other.sslEnabled;
    threadCount= other.threadCount;
+   collectMiddlewareStats= other.collectMiddlewareStats;
+   routeCacheSize= other.routeCacheSize;
+   zeroCopyBody= other.zeroCopyBody;
+   maxBodySize= other.maxBodySize;
+   streamWatermark= other.streamWatermark;
 
 #ifdef CEX_WITH_SSL
    sslVerifyMode= other.sslVerifyMode;
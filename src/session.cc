@@ -18,6 +18,24 @@
 namespace cex
 {
 
+//***************************************************************************
+// legacy property ([sessionid])
+//***************************************************************************
+
+static bool sessionProperty(Request* req, StringView key)
+{
+   SessionInfo* session= req->slot<SessionInfo>();
+
+   if (!session || key != StringView(session->name))
+      return false;
+
+   req->properties.set(session->name, session->id);
+
+   return true;
+}
+
+static const bool sessionPropertyRegistered= Request::registerPropertyShim(&sessionProperty);
+
 //***************************************************************************
 // Middleware sessionHandler
 //***************************************************************************
@@ -33,7 +51,7 @@ MiddlewareFunction sessionHandler(const std::shared_ptr<SessionOptions>& opts)
    {
       SessionOptions* theOpts = opts.get() ? opts.get() : &defaultSessionOptions;
       std::string sessionIDName= theOpts->name;
-      auto cookie = req->get("Cookie");
+      auto cookie = req->get(hdr::Cookie);
 
       if (!sessionIDName.length())
 	  sessionIDName= "sessionId";
@@ -62,20 +80,22 @@ MiddlewareFunction sessionHandler(const std::shared_ptr<SessionOptions>& opts)
 		  cookieValue= *cookieIt;
 
 		  if (!cookieName.compare(sessionIDName))
-		     req->properties.set(sessionIDName, cookieValue);
+		     req->emplaceSlot<SessionInfo>(SessionInfo{ sessionIDName, cookieValue });
 	       }
 	    }
 	 }
       }
 
-      if (!req->properties.has(sessionIDName))
+      SessionInfo* session= req->slot<SessionInfo>();
+
+      if (!session || session->name != sessionIDName)
       {
 	 // build new cookie when we have no sessionID yet
 	 // add all the options according to session-options
 
 	 std::string newSessionId= randomStringHex(32);
 
-         req->properties.set(sessionIDName, newSessionId);
+         req->emplaceSlot<SessionInfo>(SessionInfo{ sessionIDName, newSessionId });
 
 	 std::string setCookie= sessionIDName + "=" + newSessionId;
 
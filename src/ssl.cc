@@ -145,7 +145,7 @@ void Server::getSslClientInfo(Request* req)
    if (!connection || !connection->ssl || !htp_sslutil_cert_tostr(connection->ssl))
       return;
 
-   CertificateInfo* cert= new CertificateInfo;
+   CertificateInfo* cert= &req->emplaceSlot<CertificateInfo>();
 
    cert->subject= (const char*)htp_sslutil_subject_tostr(connection->ssl);
    cert->issuer= (const char*)htp_sslutil_issuer_tostr(connection->ssl);
@@ -155,10 +155,31 @@ void Server::getSslClientInfo(Request* req)
    cert->sha1= (const char*)htp_sslutil_sha1_tostr(connection->ssl);
    cert->notBefore= (const char*)htp_sslutil_notbefore_tostr(connection->ssl);
    cert->notAfter= (const char*)htp_sslutil_notafter_tostr(connection->ssl);
+}
+
+//***************************************************************************
+// legacy property (sslClientCert)
+//***************************************************************************
+
+static bool sslClientCertProperty(Request* req, StringView key)
+{
+   if (key != "sslClientCert")
+      return false;
 
-   req->properties.set("sslClientCert", cert);
+   CertificateInfo* cert= req->slot<CertificateInfo>();
+
+   if (!cert)
+      return false;
+
+   // owned by the slot, thus no deleter
+
+   req->properties.set("sslClientCert", (void*)cert);
+
+   return true;
 }
 
+static const bool sslClientCertPropertyRegistered= Request::registerPropertyShim(&sslClientCertProperty);
+
 } // namespace cex
 
 #endif // CEX_WITH_SSL
@@ -236,6 +236,98 @@ int compress(std::istream* stream, std::function<void(char*,size_t)> onChunk, Co
    return done;
 }
 
+//***************************************************************************
+// class StreamCompressor
+//***************************************************************************
+
+StreamCompressor::StreamCompressor(CompressionMode compMode)
+   : strm(new z_stream())
+{
+   int res;
+
+   strm->zalloc = Z_NULL;
+   strm->zfree = Z_NULL;
+   strm->opaque = Z_NULL;
+
+   if (compMode == cmGZip)
+      res = deflateInit2(strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 | 16 /* GZIP encoding */, 8, Z_DEFAULT_STRATEGY);
+   else
+      res = deflateInit(strm, Z_DEFAULT_COMPRESSION);
+
+   if (res != Z_OK)
+   {
+      delete strm;
+      strm= nullptr;
+   }
+}
+
+StreamCompressor::~StreamCompressor()
+{
+   if (!strm)
+      return;
+
+   deflateEnd(strm);
+   delete strm;
+}
+
+int StreamCompressor::write(const char* src, size_t srcLen, struct evbuffer* dest)
+{
+   if (!strm || !dest)
+      return fail;
+
+   if (!srcLen)
+      return done;
+
+   strm->avail_in = srcLen;
+   strm->next_in = (Bytef*)src;
+
+   return deflateTo(dest, Z_NO_FLUSH);
+}
+
+int StreamCompressor::finish(struct evbuffer* dest)
+{
+   if (!strm || !dest)
+      return fail;
+
+   strm->avail_in = 0;
+   strm->next_in = Z_NULL;
+
+   return deflateTo(dest, Z_FINISH);
+}
+
+int StreamCompressor::deflateTo(struct evbuffer* dest, int flush)
+{
+   // deflate directly into the destination buffer until zlib does not fill the space anymore
+
+   do
+   {
+      struct evbuffer_iovec vec;
+
+      if (evbuffer_reserve_space(dest, IO_BUFFER_SIZE, &vec, 1) < 1)
+         return fail;
+
+      strm->avail_out = vec.iov_len;
+      strm->next_out = (Bytef*)vec.iov_base;
+
+      int res = deflate(strm, flush);
+
+      vec.iov_len -= strm->avail_out;
+      evbuffer_commit_space(dest, &vec, 1);
+
+      if (res == Z_STREAM_ERROR)
+      {
+         deflateEnd(strm);
+         delete strm;
+         strm= nullptr;
+
+         return fail;
+      }
+   }
+   while (strm->avail_out == 0);
+
+   return done;
+}
+
 #endif // CEX_WITH_ZLIB
 
 //***************************************************************************
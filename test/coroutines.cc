@@ -0,0 +1,125 @@
+//*************************************************************************
+// File coroutines.cc
+// Date 16.10.2026 - #1
+// Copyright (c) 2018-2026 by Patrick Fial
+//-------------------------------------------------------------------------
+// cex Library coroutine middleware testcases
+//*************************************************************************
+
+//***************************************************************************
+// includes
+//***************************************************************************
+
+#include <bandit/bandit.h>
+#include <httplib.h>
+#include <cex.hpp>
+#include <cex/coro.hpp>
+
+using namespace snowhouse;
+using namespace bandit;
+
+//***************************************************************************
+// testcase definitions
+//***************************************************************************
+
+#ifdef CEX_WITH_COROUTINES
+static cex::Task<int> twice(int value)
+{
+   co_await cex::delay(std::chrono::milliseconds(5));
+   co_return value * 2;
+}
+#endif
+
+go_bandit([]() 
+{
+#ifdef CEX_WITH_COROUTINES
+   //************************************************************************
+   // coroutine middlewares
+   //************************************************************************
+
+   describe("Coroutine middlewares", []() 
+   {
+      int port= 15555;
+      const char* host= "127.0.0.1";
+
+      cex::Server app;
+      httplib::Client cli(host, port);
+
+      app.get("/timer", cex::coroutine([](cex::Request* req, cex::Response* res, cex::Next next) -> cex::Task<>
+      {
+         int value= co_await twice(21);
+
+         res->end(std::to_string(value), 200);
+      }));
+
+      app.get("/offload", cex::coroutine([](cex::Request* req, cex::Response* res, cex::Next next) -> cex::Task<>
+      {
+         std::string result= co_await cex::offload([]() { return std::string("from a worker"); });
+
+         res->end(std::move(result), 200);
+      }));
+
+      app.get("/chain", cex::coroutine([](cex::Request* req, cex::Response* res, cex::Next next) -> cex::Task<>
+      {
+         co_await cex::delay(std::chrono::milliseconds(5));
+
+         req->properties.set("coroutine", std::string("resumed"));
+         co_await next();
+      }));
+
+      app.get("/throws", cex::coroutine([](cex::Request* req, cex::Response* res, cex::Next next) -> cex::Task<>
+      {
+         co_await cex::offload([]() -> int { throw std::runtime_error("failed"); });
+
+         res->end(200);
+      }));
+
+      app.use([](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->end(req->properties.getString("coroutine"), 200);
+      });
+
+      app.listen(host, port, 0 /* don't block */);
+
+      //*********************************************************************
+      // testcases
+      //*********************************************************************
+
+      it("should resume after awaiting a timer in a nested task (/timer)", [&]() 
+      {
+         auto res = cli.Get("/timer");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body, Equals("42"));
+      });
+
+      it("should resume with the result of an offloaded job (/offload)", [&]() 
+      {
+         auto res = cli.Get("/offload");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body, Equals("from a worker"));
+      });
+
+      it("should continue with the next middleware after resuming (/chain)", [&]() 
+      {
+         auto res = cli.Get("/chain");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body, Equals("resumed"));
+      });
+
+      it("should answer uncaught exceptions with 500 (/throws)", [&]() 
+      {
+         auto res = cli.Get("/throws");
+
+         AssertThat(res->status, Equals(500));
+      });
+   });
+#endif
+});
+
+int main(int argc, char* argv[])
+{
+   return bandit::run(argc, argv);
+}
@@ -19,6 +19,9 @@
 #include <cex.hpp>
 #include <cex/filesystem.hpp>
 
+#include <fstream>
+#include <sstream>
+
 #ifdef CEX_WITH_SSL
 #  include <openssl/md5.h>
 #endif
@@ -52,6 +55,12 @@ go_bandit([]()
 
       fsOpts.get()->rootPath= "testdata/filesystem";
 
+      std::shared_ptr<cex::FilesystemOptions> plainOpts(new cex::FilesystemOptions());
+
+      plainOpts.get()->rootPath= "testdata/filesystem";
+      plainOpts.get()->etag= false;
+      plainOpts.get()->lastModified= false;
+
       // add middlewares to enable compression on per-request base
 
       app.use("/gzipContent", [](cex::Request* req, cex::Response* res, std::function<void()> next)
@@ -66,11 +75,25 @@ go_bandit([]()
          next();
       });
 
+      // large streamed response, paused at a small output buffer watermark
+
+      std::string large;
+
+      for (int i= 0; i < 4*1024*1024; i++)
+         large.push_back('a' + i % 26);
+
+      app.use("/streamed", [&large](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->setStreamWatermark(64*1024);
+         res->stream(200, std::unique_ptr<std::istream>(new std::istringstream(large)));
+      });
+
       // different routings/endpoints but same source folder on filesystem
 
       app.use("/gzipContent", cex::filesystem(fsOpts));
       app.use("/deflateContent", cex::filesystem(fsOpts));
       app.use("/content", cex::filesystem(fsOpts));
+      app.use("/plain", cex::filesystem(plainOpts));
 
       app.use(cex::filesystem(fsOpts));
 
@@ -81,6 +104,12 @@ go_bandit([]()
 
       app.listen(host, port, 0 /* don't block */);
 
+      // contents of testdata2.bin to compare byte ranges with
+
+      std::ifstream binFile("testdata/filesystem/testdata2.bin", std::ios::in|std::ios::binary);
+      std::string binary((std::istreambuf_iterator<char>(binFile)), std::istreambuf_iterator<char>());
+      std::string binSize= std::to_string(binary.size());
+
       //*********************************************************************
       // testcases
       //*********************************************************************
@@ -93,6 +122,8 @@ go_bandit([]()
          AssertThat(res->body.c_str(), Equals(payload));
          AssertThat(res->has_header("Content-Encoding"), Equals(false));
          AssertThat(res->get_header_value("Content-Type"), Equals(std::string("text/plain; charset=utf-8")));
+         AssertThat(res->get_header_value("Content-Length"), Equals(std::to_string(strlen(payload))));
+         AssertThat(res->has_header("Transfer-Encoding"), Equals(false));
       });
 
 #ifdef CEX_WITH_SSL
@@ -116,6 +147,127 @@ go_bandit([]()
          AssertThat(res->has_header("Content-Encoding"), Equals(false));
       });
 
+      it("should answer a single byte range with 206 (/content/testdata2.bin, bytes=0-99)", [&]() 
+      {
+         auto res = cli.Get("/content/testdata2.bin", { { "Range", "bytes=0-99" } });
+
+         AssertThat(res->status, Equals(206));
+         AssertThat(res->get_header_value("Content-Range"), Equals("bytes 0-99/" + binSize));
+         AssertThat(res->get_header_value("Accept-Ranges"), Equals(std::string("bytes")));
+         AssertThat(res->body.size(), Equals(100));
+         AssertThat(res->body == binary.substr(0, 100), Equals(true));
+      });
+
+      it("should answer a suffix byte range with the end of the file (/content/testdata2.bin, bytes=-100)", [&]() 
+      {
+         auto res = cli.Get("/content/testdata2.bin", { { "Range", "bytes=-100" } });
+
+         AssertThat(res->status, Equals(206));
+         AssertThat(res->get_header_value("Content-Range"), Equals("bytes " + std::to_string(binary.size() - 100) + "-" + std::to_string(binary.size() - 1) + "/" + binSize));
+         AssertThat(res->body == binary.substr(binary.size() - 100), Equals(true));
+      });
+
+      it("should answer multiple byte ranges with multipart/byteranges (/content/testdata2.bin, bytes=0-9,1000-1009)", [&]() 
+      {
+         auto res = cli.Get("/content/testdata2.bin", { { "Range", "bytes=0-9,1000-1009" } });
+
+         AssertThat(res->status, Equals(206));
+         AssertThat(res->get_header_value("Content-Type").find("multipart/byteranges; boundary="), Equals(0));
+         AssertThat(res->body.find("Content-Range: bytes 0-9/" + binSize + "\r\n\r\n" + binary.substr(0, 10)), Is().Not().EqualTo(std::string::npos));
+         AssertThat(res->body.find("Content-Range: bytes 1000-1009/" + binSize + "\r\n\r\n" + binary.substr(1000, 10)), Is().Not().EqualTo(std::string::npos));
+      });
+
+      it("should answer unsatisfiable byte ranges with 416 (/content/testdata2.bin)", [&]() 
+      {
+         auto res = cli.Get("/content/testdata2.bin", { { "Range", "bytes=" + binSize + "-" } });
+
+         AssertThat(res->status, Equals(416));
+         AssertThat(res->get_header_value("Content-Range"), Equals("bytes */" + binSize));
+      });
+
+      it("should send the whole file if If-Range does not match (/content/testdata2.bin)", [&]() 
+      {
+         auto res = cli.Get("/content/testdata2.bin", { { "Range", "bytes=0-99" }, { "If-Range", "Sun, 06 Nov 1994 08:49:37 GMT" } });
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.size(), Equals(binary.size()));
+         AssertThat(res->get_header_value("Accept-Ranges"), Equals(std::string("bytes")));
+      });
+
+      it("should send the validators ETag and Last-Modified (/content/testdata2.bin)", [&]() 
+      {
+         auto res = cli.Get("/content/testdata2.bin");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->get_header_value("ETag").front(), Equals('"'));
+         AssertThat(res->get_header_value("Last-Modified").size(), Equals(29));
+      });
+
+      it("should answer a matching If-None-Match with 304 (/content/testdata2.bin)", [&]() 
+      {
+         std::string etag= cli.Get("/content/testdata2.bin")->get_header_value("ETag");
+         auto res = cli.Get("/content/testdata2.bin", { { "If-None-Match", "\"other\", " + etag } });
+
+         AssertThat(res->status, Equals(304));
+         AssertThat(res->body.size(), Equals(0));
+         AssertThat(res->get_header_value("ETag"), Equals(etag));
+      });
+
+      it("should answer If-Modified-Since with 304 only if the file was not modified (/content/testdata2.bin)", [&]() 
+      {
+         std::string lastModified= cli.Get("/content/testdata2.bin")->get_header_value("Last-Modified");
+         auto res = cli.Get("/content/testdata2.bin", { { "If-Modified-Since", lastModified } });
+
+         AssertThat(res->status, Equals(304));
+         AssertThat(res->body.size(), Equals(0));
+
+         res = cli.Get("/content/testdata2.bin", { { "If-Modified-Since", "Sun, 06 Nov 1994 08:49:37 GMT" } });
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.size(), Equals(binary.size()));
+      });
+
+      it("should answer a byte range if If-Range matches the ETag (/content/testdata2.bin)", [&]() 
+      {
+         std::string etag= cli.Get("/content/testdata2.bin")->get_header_value("ETag");
+         auto res = cli.Get("/content/testdata2.bin", { { "Range", "bytes=0-99" }, { "If-Range", etag } });
+
+         AssertThat(res->status, Equals(206));
+         AssertThat(res->body == binary.substr(0, 100), Equals(true));
+      });
+
+      it("should neither send nor evaluate validators if disabled (/plain/testdata2.bin)", [&]() 
+      {
+         auto res = cli.Get("/plain/testdata2.bin", { { "If-None-Match", "*" } });
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->has_header("ETag"), Equals(false));
+         AssertThat(res->has_header("Last-Modified"), Equals(false));
+
+         std::string etag= cli.Get("/content/testdata2.bin")->get_header_value("ETag");
+         res = cli.Get("/plain/testdata2.bin", { { "Range", "bytes=0-99" }, { "If-Range", etag } });
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.size(), Equals(binary.size()));
+      });
+
+      it("should stream large contents paused at the output buffer watermark (/streamed)", [&]() 
+      {
+         auto res = cli.Get("/streamed");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.size(), Equals(large.size()));
+         AssertThat(res->body == large, Equals(true));
+      });
+
+      it("should answer directories with 404 (/content/)", [&]() 
+      {
+         auto res = cli.Get("/content/");
+
+         AssertThat(res->status, Equals(404));
+         AssertThat(res->body.size(), Equals(0));
+      });
+
       it("should not allow absolute file paths to access files outside the middleware root path (/bin/sh)", [&]() 
       {
          auto res = cli.Get("/bin/sh");
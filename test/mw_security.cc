@@ -63,6 +63,15 @@ go_bandit([]()
          res->end(200);
       });
 
+      static const cex::HeaderBlock block({ { "X-Block-One", "1" }, { "X-Block-Two", "2" } });
+
+      app.use("/withblock",  [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->set(block);
+         res->setStatic("X-Static", "static");
+         res->end(200);
+      });
+
       app.listen(host, port, 0 /* don't block */);
 
       //*********************************************************************
@@ -102,6 +111,16 @@ go_bandit([]()
          AssertThat(res->has_header("Referrer-Policy"), Equals(false));
          AssertThat(res->has_header("X-XSS-Protection"), Equals(false));
       });
+
+      it("should set the headers of a HeaderBlock and static headers for GET /withblock", [&]() 
+      {
+         auto res = cli.Get("/withblock");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->get_header_value("X-Block-One"), Equals("1"));
+         AssertThat(res->get_header_value("X-Block-Two"), Equals("2"));
+         AssertThat(res->get_header_value("X-Static"), Equals("static"));
+      });
    });
 });
 
@@ -63,6 +63,16 @@ go_bandit([]()
          res->end(200);
       });
 
+      app.use("/sessionslot", cex::sessionHandler(opts));
+      app.use("/sessionslot",  [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         cex::SessionInfo* session= req->slot<cex::SessionInfo>();
+
+         std::string body= session ? session->id + "|" + req->properties.getString("sessionID") : std::string();
+
+         res->end(body.c_str(), session ? 200 : 500);
+      });
+
       app.listen(host, port, 0 /* don't block */);
 
       //*********************************************************************
@@ -99,6 +109,16 @@ go_bandit([]()
          AssertThat(res->status, Equals(200));
          AssertThat(res->has_header("Set-Cookie"), Equals(false));
       });
+
+      it("should provide the session ID both as slot and as property for GET /sessionslot", [&]() 
+      {
+         httplib::Headers headers= { { "Cookie", "other=1; sessionID=ABCDEF" } };
+         auto res = cli.Get("/sessionslot", headers);
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("ABCDEF|ABCDEF"));
+         AssertThat(res->has_header("Set-Cookie"), Equals(false));
+      });
    });
 });
 
@@ -14,6 +14,8 @@
 #include <httplib.h>
 #include <cex.hpp>
 
+#include <thread>
+
 using namespace snowhouse;
 using namespace bandit;
 
@@ -61,6 +63,51 @@ go_bandit([]()
          res->end(payload, 200);
       }, cex::Middleware::fMatchCompare);
 
+      app.use("/views/", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         std::string result= req->url().str() + "|" + req->path().str() + "|" + req->host().str() + "|" + req->header("X-Test").str() + "|" + req->header(cex::hdr::Cookie).str();
+
+         res->end(result.c_str(), 200);
+      }, cex::Middleware::fMatchContain);
+
+      app.use("/owned/string", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         std::string body= "owned string";
+
+         res->end(std::move(body), 200);
+      }, cex::Middleware::fMatchCompare);
+
+      app.use("/owned/vector", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         std::vector<char> body= { 'o', 'w', 'n', 'e', 'd' };
+
+         res->end(std::move(body), 200);
+      }, cex::Middleware::fMatchCompare);
+
+      std::shared_ptr<const cex::Buffer> shared= std::make_shared<const cex::Buffer>("{\"cached\": true}");
+
+      app.use("/shared", [shared](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->end(shared, 200);
+      }, cex::Middleware::fMatchCompare);
+
+      std::shared_ptr<const cex::Buffer> header= std::make_shared<const cex::Buffer>("<header>");
+
+      app.use("/builder", [header](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         cex::ResponseBuilder builder;
+
+         builder.append(header).append(std::string("body")).appendStatic("<footer>", 8);
+         res->end(std::move(builder), 200);
+      }, cex::Middleware::fMatchCompare);
+
+      app.use("/parts", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         std::string body("body");
+         struct iovec parts[]= { { (void*)"<header>", 8 }, { (void*)body.data(), body.size() }, { (void*)"<footer>", 8 } };
+
+         res->end(parts, 3, 200);
+      }, cex::Middleware::fMatchCompare);
 
       app.use([&payload](cex::Request* req, cex::Response* res, std::function<void()> next)
       {
@@ -99,6 +146,59 @@ go_bandit([]()
       });
 
 
+      it("should return views of url, path, host and (well-known) headers for /views/file.txt", [&]() 
+      {
+         httplib::Headers headers= { { "X-Test", "value" }, { "cookie", "a=1" } };
+         auto res = cli.Get("/views/file.txt", headers);
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("/views/file.txt|/views/|127.0.0.1|value|a=1"));
+      });
+
+      it("should send exactly the moved string for GET /owned/string", [&]() 
+      {
+         auto res = cli.Get("/owned/string");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body, Equals("owned string"));
+         AssertThat(res->get_header_value("Content-Length"), Equals("12"));
+      });
+
+      it("should send exactly the moved vector for GET /owned/vector", [&]() 
+      {
+         auto res = cli.Get("/owned/vector");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body, Equals("owned"));
+      });
+
+      it("should return the same shared payload for repeated GET /shared", [&]() 
+      {
+         for (int i= 0; i < 3; i++)
+         {
+            auto res = cli.Get("/shared");
+
+            AssertThat(res->status, Equals(200));
+            AssertThat(res->body, Equals("{\"cached\": true}"));
+         }
+      });
+
+      it("should return the fragments of a ResponseBuilder in order for GET /builder", [&]() 
+      {
+         auto res = cli.Get("/builder");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body, Equals("<header>body<footer>"));
+      });
+
+      it("should return all parts in order for GET /parts", [&]() 
+      {
+         auto res = cli.Get("/parts");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body, Equals("<header>body<footer>"));
+      });
+
       it("should return 400 for /test", [&]() 
       {
          auto res = cli.Get("/test");
@@ -123,6 +223,526 @@ go_bandit([]()
       });
    });
 
+   //************************************************************************
+   // Overlapping routes
+   //************************************************************************
+
+   describe("Overlapping routes keep registration order", []()
+   {
+      int port= 15555;
+      const char* host= "127.0.0.1";
+
+      cex::Server app;
+      httplib::Client cli(host, port);
+
+      app.use([](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         req->properties.set("trace", std::string("global"));
+         next();
+      });
+
+      app.use("/api", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         req->properties.set("trace", req->properties.getString("trace") + ",contain");
+         next();
+      });
+
+      app.get("/api/items", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         req->properties.set("trace", req->properties.getString("trace") + ",compare");
+         next();
+      }, cex::Middleware::fMatchCompare);
+
+      app.use("items$", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         req->properties.set("trace", req->properties.getString("trace") + ",regex");
+         next();
+      }, cex::Middleware::fMatchRegex);
+
+      app.use("/ap", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         req->properties.set("trace", req->properties.getString("trace") + ",prefix");
+         next();
+      });
+
+      app.use([](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->end(req->properties.getString("trace").c_str(), 200);
+      });
+
+      app.listen(host, port, 0 /* don't block */);
+
+      //*********************************************************************
+      // testcases
+      //*********************************************************************
+
+      it("should call all matching middlewares in registration order (/api/items)", [&]()
+      {
+         auto res = cli.Get("/api/items");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("global,contain,compare,regex,prefix"));
+      });
+
+      it("should skip the method and compare middlewares for POST /v1/api/items/x", [&]()
+      {
+         auto res = cli.Post("/v1/api/items/x", "name=john1", "application/x-www-form-urlencoded");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("global,contain,prefix"));
+      });
+   });
+
+   //************************************************************************
+   // Path parameters
+   //************************************************************************
+
+   describe("Pattern routes with path parameters", []()
+   {
+      int port= 15555;
+      const char* host= "127.0.0.1";
+
+      cex::Server app;
+      httplib::Client cli(host, port);
+
+      app.get("/users/:id/orders/*rest", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         std::string body= req->getParam("id").str() + "|" + req->getParam("rest").str();
+         res->end(body.c_str(), 200);
+      }, cex::Middleware::fMatchPattern);
+
+      app.get("/users/:id", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->end(req->getParam("id").str().c_str(), 200);
+      }, cex::Middleware::fMatchPattern);
+
+      app.use([](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->end(404);
+      });
+
+      app.listen(host, port, 0 /* don't block */);
+
+      //*********************************************************************
+      // testcases
+      //*********************************************************************
+
+      it("should capture a single segment parameter (/users/123)", [&]()
+      {
+         auto res = cli.Get("/users/123");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("123"));
+      });
+
+      it("should capture segment and wildcard parameters (/users/42/orders/a/b)", [&]()
+      {
+         auto res = cli.Get("/users/42/orders/a/b");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("42|a/b"));
+      });
+
+      it("should not match empty or additional segments (/users/, /users/1/x)", [&]()
+      {
+         auto res0 = cli.Get("/users/");
+         auto res1 = cli.Get("/users/1/x");
+
+         AssertThat(res0->status, Equals(404));
+         AssertThat(res1->status, Equals(404));
+      });
+   });
+
+   //************************************************************************
+   // Regular expressions
+   //************************************************************************
+
+   describe("Regex routes matched as a set", []()
+   {
+      int port= 15555;
+      const char* host= "127.0.0.1";
+
+      cex::Server app;
+      httplib::Client cli(host, port);
+
+      app.use("^/api/v[0-9]+/", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         req->properties.set("trace", std::string("version"));
+         next();
+      }, cex::Middleware::fMatchRegex);
+
+      app.use("/(\\w+)/\\1$", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         req->properties.set("trace", req->properties.getString("trace") + ",repeat");
+         next();
+      }, cex::Middleware::fMatchRegex);
+
+      app.use("\\.(png|jpe?g)$", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         req->properties.set("trace", req->properties.getString("trace") + ",image");
+         next();
+      }, cex::Middleware::fMatchRegex);
+
+      app.use([](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->end(req->properties.getString("trace").c_str(), 200);
+      });
+
+      app.listen(host, port, 0 /* don't block */);
+
+      //*********************************************************************
+      // testcases
+      //*********************************************************************
+
+      it("should run all matching expressions in registration order", [&]()
+      {
+         auto res = cli.Get("/api/v2/img/img/logo.jpeg");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("version,image"));
+      });
+
+      it("should evaluate unsupported syntax (back references) separately", [&]()
+      {
+         auto res = cli.Get("/api/v10/img/img");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("version,repeat"));
+      });
+
+      it("should skip expressions which do not match", [&]()
+      {
+         auto res = cli.Get("/apix/v1/logo.gif");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals(""));
+      });
+   });
+
+   //************************************************************************
+   // Middleware dispatching
+   //************************************************************************
+
+   describe("Middleware chain dispatching", []()
+   {
+      int port= 15555;
+      const char* host= "127.0.0.1";
+
+      cex::Server app;
+      httplib::Client cli(host, port);
+
+      for (int i= 0; i < 1000; i++)
+      {
+         std::string path= "/skip/" + std::to_string(i);
+
+         app.get(path.c_str(), [](cex::Request* req, cex::Response* res, std::function<void()> next)
+         {
+            res->end(500);
+         }, cex::Middleware::fMatchCompare);
+      }
+
+      app.use([](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         req->properties.set("calls", req->properties.getLong("calls") + 1);
+
+         // a second call must not run the rest of the chain again
+
+         next();
+         next();
+      });
+
+      app.use([](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         req->properties.set("calls", req->properties.getLong("calls") + 1);
+         next();
+      });
+
+      app.use([](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->end(std::to_string(req->properties.getLong("calls")).c_str(), 200);
+      });
+
+      app.listen(host, port, 0 /* don't block */);
+
+      //*********************************************************************
+      // testcases
+      //*********************************************************************
+
+      it("should call each matching middleware once", [&]()
+      {
+         auto res = cli.Get("/dispatch");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("2"));
+      });
+   });
+
+   //************************************************************************
+   // Asynchronous responses
+   //************************************************************************
+
+   describe("Suspended requests completed from other threads", []()
+   {
+      int port= 15555;
+      const char* host= "127.0.0.1";
+
+      cex::Server app;
+      httplib::Client cli(host, port);
+
+      app.get("/async/end", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         cex::AsyncHandlePtr handle= res->suspend();
+
+         std::thread([handle]()
+         {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            handle->end(std::string("done later"), 200);
+         }).detach();
+      });
+
+      app.get("/async/next", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         cex::AsyncHandlePtr handle= res->suspend();
+
+         std::thread([handle]()
+         {
+            handle->post([](cex::Request* req, cex::Response* res, std::function<void()> next)
+            {
+               req->properties.set("worker", std::string("yes"));
+               next();
+            });
+         }).detach();
+      });
+
+      app.use([](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->end(req->properties.getString("worker"), 200);
+      });
+
+      app.listen(host, port, 0 /* don't block */);
+
+      //*********************************************************************
+      // testcases
+      //*********************************************************************
+
+      it("should send a response ended by another thread", [&]()
+      {
+         auto res = cli.Get("/async/end");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body, Equals("done later"));
+      });
+
+      it("should continue the chain when another thread calls next", [&]()
+      {
+         auto res = cli.Get("/async/next");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body, Equals("yes"));
+      });
+
+      it("should serve repeated suspended requests", [&]()
+      {
+         for (int i= 0; i < 3; i++)
+         {
+            auto res = cli.Get("/async/end");
+
+            AssertThat(res->status, Equals(200));
+         }
+      });
+   });
+
+   //************************************************************************
+   // Route cache
+   //************************************************************************
+
+   describe("Route cache", []()
+   {
+      int port= 15555;
+      const char* host= "127.0.0.1";
+
+      cex::Server::Config config;
+      config.threadCount= 1;
+      config.routeCacheSize= 16;
+
+      cex::Server app(config);
+      httplib::Client cli(host, port);
+
+      app.get("/cached", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->end("first", 200);
+      }, cex::Middleware::fMatchCompare);
+
+      app.use([](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->end(404);
+      });
+
+      app.listen(host, port, 0 /* don't block */);
+
+      //*********************************************************************
+      // testcases
+      //*********************************************************************
+
+      it("should serve repeated requests from the cache", [&]()
+      {
+         auto res0 = cli.Get("/cached");
+         auto res1 = cli.Get("/cached");
+
+         AssertThat(res0->status, Equals(200));
+         AssertThat(res1->body.c_str(), Equals("first"));
+         AssertThat(app.getRouteCacheStats().hits, IsGreaterThanOrEqualTo(1ULL));
+      });
+
+      it("should invalidate the cache when routes change", [&]()
+      {
+         app.reset();
+
+         app.get("/cached", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+         {
+            res->end("second", 200);
+         }, cex::Middleware::fMatchCompare);
+
+         auto res = cli.Get("/cached");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("second"));
+      });
+   });
+
+   //************************************************************************
+   // Reconfiguration
+   //************************************************************************
+
+   describe("Changing routes while the server is running", []()
+   {
+      int port= 15555;
+      const char* host= "127.0.0.1";
+
+      cex::Server app;
+      httplib::Client cli(host, port);
+
+      app.use([](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->end(404);
+      });
+
+      app.listen(host, port, 0 /* don't block */);
+
+      //*********************************************************************
+      // testcases
+      //*********************************************************************
+
+      it("should serve routes added after the server was started", [&]()
+      {
+         AssertThat(cli.Get("/late")->status, Equals(404));
+
+         app.reset();
+
+         app.get("/late", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+         {
+            res->end("late", 200);
+         }, cex::Middleware::fMatchCompare);
+
+         auto res = cli.Get("/late");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("late"));
+      });
+
+      it("should keep serving requests while routes are replaced", [&]()
+      {
+         std::atomic<bool> done(false);
+
+         std::thread writer([&]()
+         {
+            for (int i= 0; i < 200; i++)
+            {
+               app.use(("/tmp" + std::to_string(i)).c_str(), [](cex::Request* req, cex::Response* res, std::function<void()> next)
+               {
+                  next();
+               });
+            }
+
+            done= true;
+         });
+
+         int failures= 0;
+
+         while (!done)
+         {
+            auto res = cli.Get("/late");
+
+            if (!res || res->status != 200)
+               failures++;
+         }
+
+         writer.join();
+
+         AssertThat(failures, Equals(0));
+      });
+   });
+
+   //************************************************************************
+   // Middleware statistics
+   //************************************************************************
+
+   describe("Middleware statistics", []()
+   {
+      int port= 15555;
+      const char* host= "127.0.0.1";
+
+      cex::Server::Config config;
+      config.collectMiddlewareStats= true;
+
+      cex::Server app(config);
+      httplib::Client cli(host, port);
+
+      app.use("/stats", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         next();
+      });
+
+      app.get("/stats/end", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->end(200);
+      }, cex::Middleware::fMatchCompare);
+
+      app.get("/other", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         res->end(200);
+      });
+
+      app.listen(host, port, 0 /* don't block */);
+
+      //*********************************************************************
+      // testcases
+      //*********************************************************************
+
+      it("should count matches and invocations per middleware", [&]()
+      {
+         cli.Get("/stats/end");
+         cli.Get("/stats/end");
+
+         auto stats= app.middlewareStats();
+
+         AssertThat(stats.size(), Equals(3u));
+         AssertThat(stats[0].path, Equals("/stats"));
+         AssertThat(stats[0].matches, Equals(2ULL));
+         AssertThat(stats[0].invocations, Equals(2ULL));
+         AssertThat(stats[1].index, Equals(1u));
+         AssertThat(stats[1].invocations, Equals(2ULL));
+         AssertThat(stats[2].matches, Equals(0ULL));
+
+         unsigned long long histogramTotal= 0;
+
+         for (auto count : stats[1].histogram)
+            histogramTotal += count;
+
+         AssertThat(histogramTotal, Equals(2ULL));
+      });
+   });
+
    //************************************************************************
    // Method based routing
    //************************************************************************
@@ -106,6 +106,104 @@ go_bandit([]()
       });
 #endif
    });
+
+   describe("Request bodies kept in the receive buffer", []()
+   {
+      int port= 15555;
+      const char* host= "127.0.0.1";
+
+      cex::Server::Config config;
+      config.zeroCopyBody= true;
+
+      cex::Server app(config);
+      httplib::Client cli(host, port);
+
+      app.post("/body", [](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         std::string joined;
+
+         for (const auto& segment : req->bodySegments())
+            joined.append(segment.data(), segment.size());
+
+         std::string linear(req->getBody(), req->getBodyLength());
+         std::string result= std::to_string(joined.size()) + (joined == linear ? "|equal" : "|different");
+
+         res->end(result.c_str(), 200);
+      });
+
+      app.listen(host, port, 0 /* don't block */);
+
+      //*********************************************************************
+      // testcases
+      //*********************************************************************
+
+      it("should expose the same body as segments and as linear buffer", [&]()
+      {
+         std::string contents;
+
+         for (int i= 0; i < 1024*1024; i++)
+            contents.push_back((char)('a' + i % 26));
+
+         auto res = cli.Post("/body", contents, "application/octet-stream");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("1048576|equal"));
+      });
+   });
+
+   describe("Request body limits", []()
+   {
+      int port= 15555;
+      const char* host= "127.0.0.1";
+
+      cex::Server::Config config;
+      config.maxBodySize= 1024;
+
+      cex::Server app(config);
+      httplib::Client cli(host, port);
+
+      app.maxBodySize("/large", 64*1024);
+
+      app.post([](cex::Request* req, cex::Response* res, std::function<void()> next)
+      {
+         std::string length= std::to_string(req->getBodyLength());
+
+         res->end(length.c_str(), 200);
+      });
+
+      app.listen(host, port, 0 /* don't block */);
+
+      //*********************************************************************
+      // testcases
+      //*********************************************************************
+
+      it("should accept a body within the global limit", [&]()
+      {
+         auto res = cli.Post("/small", std::string(1000, 'x'), "text/plain");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("1000"));
+      });
+
+      it("should return 413 for a body exceeding the global limit", [&]()
+      {
+         auto res = cli.Post("/small", std::string(2000, 'x'), "text/plain");
+
+         AssertThat(res->status, Equals(413));
+      });
+
+      it("should apply the limit of a matching route", [&]()
+      {
+         auto res = cli.Post("/large", std::string(2000, 'x'), "text/plain");
+
+         AssertThat(res->status, Equals(200));
+         AssertThat(res->body.c_str(), Equals("2000"));
+
+         res = cli.Post("/large", std::string(100*1024, 'x'), "text/plain");
+
+         AssertThat(res->status, Equals(413));
+      });
+   });
 });
 
 //***************************************************************************